@@ -0,0 +1,63 @@
+/*
+ * One block of memory for everything sized at startup.
+ * Storage is carved out of it in order and never freed on its
+ * own, the whole block goes at once when the game ends.
+ * Sizes are found by carving once from an arena with no
+ * memory, which only counts, then for real.
+ */
+#ifndef ARENA_C
+#define ARENA_C
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "types.h"
+
+/* Allocates size bytes of zeroed memory for arena.
+ * returns true on failure, false otherwise. */
+bool arena_init(Arena *arena, size_t size) {
+	arena->base = calloc(1, size);
+	arena->size = size;
+	arena->used = 0;
+	if (arena->base == NULL) {
+		ILOG("couldn't allocate %zu byte arena", size);
+		return true;
+	}
+	return false;
+}
+
+/*
+ * Carves size bytes from arena, aligned to ARENA_ALIGN.
+ * Memory is zeroed. If arena has no memory, only counts the
+ * bytes and returns NULL, see arena_used.
+ */
+void* arena_alloc(Arena *arena, size_t size) {
+	size_t start = (arena->used + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+	arena->used = start + size;
+	if (arena->base == NULL) {
+		return NULL;
+	}
+	if (arena->used > arena->size) {
+		//carving differs between counting and real passes, a bug.
+		ILOG("arena overflow, %zu of %zu bytes", arena->used, arena->size);
+		abort();
+	}
+	return arena->base + start;
+}
+
+/* bytes carved so far, including alignment */
+size_t arena_used(Arena *arena) {
+	return arena->used;
+}
+
+/* frees arena's memory. Everything carved from it goes too. */
+void arena_free(Arena *arena) {
+	free(arena->base);
+	arena->base = NULL;
+	arena->size = 0;
+	arena->used = 0;
+}
+
+#endif /* ARENA_C */
@@ -0,0 +1,450 @@
+/* Benchmarks for hot paths in the game loop.
+ * Doesn't open a window, so can run anywhere raylib links.
+ * Results are written as JSON, one entry per benchmark and size,
+ * always in the same order, so runs can be diffed and tracked.
+ * Timings are the fastest of BENCH_REPEATS runs, to cut noise.
+ * Game logging goes to stdout, so results go to a file.
+ * Run with: make bench, or ./bench [file]
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "types.h"
+#include "game.c"
+#include "collide.c"
+
+const uint32_t BENCH_ROUNDS = 200;
+const uint32_t BENCH_REPEATS = 5; //each benchmark is timed this many times, fastest is kept
+const uint32_t BENCH_SCHEMA = 1; //bump when output format changes
+const char* BENCH_DEFAULT_PATH = "bench.json";
+const uint32_t BENCH_SCALED_MAX = 6400; //most objects game_handle_objects_scaled runs with
+enum { BENCH_PAIR_OBJS = 32 }; //objects of each type in object_is_colliding benchmarks
+
+FILE *benchOut; //where results go
+uint32_t benchCount; //results written so far
+volatile float benchSink; //results are written here, so loops aren't optimized away
+
+/* returns monotonic time in seconds */
+double bench_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* exits with msg if ok is false. Unlike assert, also runs in
+ * release builds, which is what benchmarks are built as. */
+void bench_check(bool ok, const char *msg) {
+	if (!ok) {
+		fprintf(stderr, "bench check failed: %s\n", msg);
+		exit(1);
+	}
+}
+
+/* keeps the fastest of seconds and best, for min of repeats */
+double bench_best(double best, double seconds) {
+	return (best == 0 || seconds < best) ? seconds : best;
+}
+
+/* writes a result. n is the object count (or other size) it ran at,
+ * ops how many operations took seconds. */
+void bench_report(const char *name, uint32_t n, uint64_t ops, double seconds) {
+	fprintf(benchOut, "%s\n    {\"name\": \"%s\", \"n\": %u, \"ops\": %llu, \"ns_per_op\": %.3f}",
+			benchCount > 0 ? "," : "", name, n, (unsigned long long)ops,
+			ops > 0 ? seconds * 1e9 / ops : 0.0);
+	benchCount++;
+}
+
+/* allocates a fresh state with room for maxObjs objects. The world
+ * grows with maxObjs, so objects are as crowded as in a default game. */
+GameState* bench_state(uint32_t maxObjs) {
+	GameState *state = calloc(1, sizeof(GameState));
+	float scale = sqrtf((float)maxObjs / DEFAULT_MAX_OBJS);
+	bench_check(state != NULL, "couldn't allocate state");
+	state->headless = true;
+	state->limits.maxObjs = maxObjs;
+	state->limits.worldW = fmaxf(DEFAULT_WORLD_W, DEFAULT_WORLD_W * scale);
+	state->limits.worldH = fmaxf(DEFAULT_WORLD_H, DEFAULT_WORLD_H * scale);
+	bench_check(!game_init_objects(state), "couldn't allocate objects");
+	return state;
+}
+
+/* frees a state from bench_state */
+void bench_free_state(GameState *state) {
+	game_deinit(state);
+	free(state);
+}
+
+/* fills a fresh state with n objects, a mix of all types. missiles are given
+ * speed so they are checked along their path. */
+GameState* bench_populate(uint32_t n, uint32_t maxObjs) {
+	GameState *state = bench_state(maxObjs);
+	random_seed(&state->rng, n);
+	state->framecounter = 100;
+
+	for (uint32_t i = 0; i < n; i++) {
+		uint32_t type = (i % 4 == 0) ? ASTEROID : (i % 4 == 1) ? SHIP : MISSILE;
+		Object *obj = game_add_object(state, type, COLORS[i % N_COLORS]);
+		bench_check(obj != NULL, "ran out of objects");
+		if (object_is_type(obj, MISSILE)) {
+			object_adjust_speed(obj, MISSILE_SPEED);
+		}
+	}
+	return state;
+}
+
+/* compares finding first collider for all objects with a full scan
+ * against the grid broad phase, and checks they agree. */
+void bench_first_collider(uint32_t n) {
+	GameState *state = bench_populate(n, DEFAULT_MAX_OBJS);
+	uint32_t maxObjs = state->limits.maxObjs;
+	Object **scanned = malloc(maxObjs * sizeof(Object*));
+	double start, scanTime = 0, gridTime = 0;
+
+	for (uint32_t rep = 0; rep < BENCH_REPEATS; rep++) {
+		start = bench_now();
+		for (uint32_t r = 0; r < BENCH_ROUNDS; r++) {
+			for (uint32_t i = 0; i < maxObjs; i++) {
+				scanned[i] = game_scan_first_collider(state, &state->objs[i]);
+			}
+		}
+		scanTime = bench_best(scanTime, bench_now() - start);
+
+		start = bench_now();
+		for (uint32_t r = 0; r < BENCH_ROUNDS; r++) {
+			grid_build(&state->grid, &state->store, state->objs);
+			for (uint32_t i = 0; i < maxObjs; i++) {
+				Object *found = game_get_first_collider(state, &state->objs[i]);
+				bench_check(found == scanned[i], "grid and scan found different colliders");
+			}
+			grid_invalidate(&state->grid);
+		}
+		gridTime = bench_best(gridTime, bench_now() - start);
+	}
+
+	bench_report("first_collider_scan", n, (uint64_t)BENCH_ROUNDS * maxObjs, scanTime);
+	bench_report("first_collider_grid", n, (uint64_t)BENCH_ROUNDS * maxObjs, gridTime);
+	free(scanned);
+	bench_free_state(state);
+}
+
+/* fills a fresh state with asteroids and n missiles, without placement checks
+ * so they overlap. Some missiles sit exactly on asteroid corners and
+ * edges, where rounding differences would show. */
+GameState* bench_populate_missiles(uint32_t n) {
+	GameState *state = bench_state(DEFAULT_MAX_OBJS);
+	random_seed(&state->rng, n);
+
+	for (uint32_t i = 0; i < DEFAULT_MAX_ASTEROIDS; i++) {
+		object_activate(game_get_free_object(state, ASTEROID), &state->rng, ASTEROID, WHITE);
+	}
+	for (uint32_t i = 0; i < n; i++) {
+		Object *obj = game_get_free_object(state, MISSILE);
+		bench_check(obj != NULL, "ran out of objects");
+		object_activate(obj, &state->rng, MISSILE, WHITE);
+		object_adjust_speed(obj, MISSILE_SPEED);
+		if (i % 3 == 0) {
+			Object *target = &state->objs[i % DEFAULT_MAX_ASTEROIDS];
+			object_set_x(obj, object_x(target) + (i % 2) * target->w);
+			object_set_y(obj, object_y(target) + (i % 5 == 0 ? target->h / 2 : 0));
+		}
+	}
+	return state;
+}
+
+/* checks batch missile/asteroid collisions against object_is_colliding
+ * for every pair, both ways round, and times them. */
+void bench_collide_batch(uint32_t n) {
+	GameState *state = bench_populate_missiles(n);
+	uint32_t maxObjs = state->limits.maxObjs;
+	CollideBatch batch = { 0 }, *b = &batch;
+	Arena counter = { 0 }, arena;
+	bool *hits = malloc(maxObjs * maxObjs * sizeof(bool));
+	bool *scalar = malloc(maxObjs * maxObjs * sizeof(bool));
+	double start, pairTime = 0, batchTime = 0;
+
+	collide_init(b, &counter, maxObjs);
+	bench_check(!arena_init(&arena, arena_used(&counter)), "couldn't allocate batch");
+	collide_init(b, &arena, maxObjs);
+	collide_gather(b, &state->store, state->objs);
+	uint32_t m = b->nAsteroids;
+
+	for (uint32_t dir = 0; dir < 2; dir++) {
+		bool missileFirst = dir == 0;
+		collide_batch(b, missileFirst, hits);
+		collide_batch_scalar(b, missileFirst, scalar);
+		for (uint32_t i = 0; i < b->nMissiles; i++) {
+			for (uint32_t j = 0; j < m; j++) {
+				Object *missile = &state->objs[b->missiles[i]];
+				Object *asteroid = &state->objs[b->asteroids[j]];
+				bool expected = missileFirst ?
+					object_is_colliding(missile, asteroid) :
+					object_is_colliding(asteroid, missile);
+				bench_check(hits[i * m + j] == expected, "batch collision differs from object_is_colliding");
+				bench_check(scalar[i * m + j] == expected, "scalar batch collision differs from object_is_colliding");
+			}
+		}
+	}
+
+	for (uint32_t rep = 0; rep < BENCH_REPEATS; rep++) {
+		start = bench_now();
+		for (uint32_t r = 0; r < BENCH_ROUNDS; r++) {
+			for (uint32_t i = 0; i < b->nMissiles; i++) {
+				for (uint32_t j = 0; j < m; j++) {
+					Object *missile = &state->objs[b->missiles[i]];
+					Object *asteroid = &state->objs[b->asteroids[j]];
+					hits[i * m + j] = object_is_colliding(missile, asteroid) ||
+						object_is_colliding(asteroid, missile);
+				}
+			}
+		}
+		pairTime = bench_best(pairTime, bench_now() - start);
+
+		start = bench_now();
+		for (uint32_t r = 0; r < BENCH_ROUNDS; r++) {
+			collide_gather(b, &state->store, state->objs);
+			collide_batch(b, true, hits);
+			collide_batch(b, false, scalar);
+		}
+		batchTime = bench_best(batchTime, bench_now() - start);
+	}
+
+	uint64_t ops = (uint64_t)BENCH_ROUNDS * b->nMissiles * m;
+	bench_report("missile_asteroid_pairs", n, ops, pairTime);
+	bench_report("missile_asteroid_batch", n, ops, batchTime);
+	free(scalar);
+	free(hits);
+	arena_free(&arena);
+	bench_free_state(state);
+}
+
+/* times object_is_colliding for objects of type t1 against t2,
+ * n of each, crowded together so some pairs touch. */
+void bench_is_colliding(ObjectType t1, ObjectType t2, const char *name) {
+	GameState *state = bench_state(DEFAULT_MAX_OBJS);
+	Object *as[BENCH_PAIR_OBJS], *bs[BENCH_PAIR_OBJS];
+	const uint32_t n = BENCH_PAIR_OBJS;
+	const float area = 400;
+	double start, best = 0;
+	uint32_t hits = 0;
+
+	random_seed(&state->rng, t1 * N_TYPES + t2);
+	state->framecounter = 100;
+	for (uint32_t i = 0; i < 2 * n; i++) {
+		uint32_t type = i < n ? t1 : t2;
+		Object *obj = object_activate(game_get_free_object(state, type), &state->rng, type, WHITE);
+		bench_check(obj != NULL, "ran out of objects");
+		if (type == MISSILE) {
+			object_adjust_speed(obj, MISSILE_SPEED);
+		}
+		object_set_x(obj, random_float(&state->rng, area));
+		object_set_y(obj, random_float(&state->rng, area));
+		if (i < n) {
+			as[i] = obj;
+		} else {
+			bs[i - n] = obj;
+		}
+	}
+
+	for (uint32_t rep = 0; rep < BENCH_REPEATS; rep++) {
+		hits = 0;
+		start = bench_now();
+		for (uint32_t r = 0; r < BENCH_ROUNDS; r++) {
+			for (uint32_t i = 0; i < n; i++) {
+				for (uint32_t j = 0; j < n; j++) {
+					hits += object_is_colliding(as[i], bs[j]);
+				}
+			}
+		}
+		best = bench_best(best, bench_now() - start);
+	}
+	benchSink = hits;
+	bench_report(name, n, (uint64_t)BENCH_ROUNDS * n * n, best);
+	bench_free_state(state);
+}
+
+/* times object_is_colliding for every pair of types */
+void bench_is_colliding_pairs() {
+	const char *names[N_TYPES + 1][N_TYPES + 1] = {
+		[ASTEROID] = {
+			[ASTEROID] = "object_is_colliding_asteroid_asteroid",
+			[SHIP] = "object_is_colliding_asteroid_ship",
+			[MISSILE] = "object_is_colliding_asteroid_missile",
+		},
+		[SHIP] = {
+			[ASTEROID] = "object_is_colliding_ship_asteroid",
+			[SHIP] = "object_is_colliding_ship_ship",
+			[MISSILE] = "object_is_colliding_ship_missile",
+		},
+		[MISSILE] = {
+			[ASTEROID] = "object_is_colliding_missile_asteroid",
+			[SHIP] = "object_is_colliding_missile_ship",
+			[MISSILE] = "object_is_colliding_missile_missile",
+		},
+	};
+	ObjectType types[] = {ASTEROID, SHIP, MISSILE};
+
+	for (uint32_t i = 0; i < N_TYPES; i++) {
+		for (uint32_t j = 0; j < N_TYPES; j++) {
+			bench_is_colliding(types[i], types[j], names[types[i]][types[j]]);
+		}
+	}
+}
+
+/* times vector_rotate over all whole degree angles */
+void bench_vector_rotate() {
+	const uint32_t rounds = 100 * BENCH_ROUNDS;
+	Vector2 v = {3.0, 4.0};
+	double start, best = 0;
+	float acc = 0;
+
+	for (uint32_t rep = 0; rep < BENCH_REPEATS; rep++) {
+		start = bench_now();
+		for (uint32_t r = 0; r < rounds; r++) {
+			for (int angle = -360; angle <= 360; angle++) {
+				acc += vector_rotate(v, angle).x;
+			}
+		}
+		best = bench_best(best, bench_now() - start);
+	}
+	benchSink = acc;
+	bench_report("vector_rotate", 1, (uint64_t)rounds * 721, best);
+}
+
+/* times vector_get_line_intersection on random segments */
+void bench_line_intersection() {
+	const uint32_t n = 1024;
+	const uint32_t rounds = BENCH_ROUNDS;
+	Vector2 *pts = malloc(4 * n * sizeof(Vector2));
+	Random rng;
+	double start, best = 0;
+	uint32_t hits = 0;
+
+	random_seed(&rng, n);
+	for (uint32_t i = 0; i < 4 * n; i++) {
+		pts[i] = vector_random_position(&rng, SCREEN_W, SCREEN_H);
+	}
+
+	for (uint32_t rep = 0; rep < BENCH_REPEATS; rep++) {
+		hits = 0;
+		start = bench_now();
+		for (uint32_t r = 0; r < rounds; r++) {
+			for (uint32_t i = 0; i < n; i++) {
+				Vector2 *p = &pts[4 * i];
+				hits += vector_get_line_intersection(p[0].x, p[0].y, p[1].x, p[1].y,
+						p[2].x, p[2].y, p[3].x, p[3].y, NULL, NULL);
+			}
+		}
+		best = bench_best(best, bench_now() - start);
+	}
+	benchSink = hits;
+	bench_report("vector_get_line_intersection", n, (uint64_t)rounds * n, best);
+	free(pts);
+}
+
+/* times finding a free slot with n objects already live */
+void bench_free_object(uint32_t n) {
+	GameState *state = bench_populate(n, DEFAULT_MAX_OBJS);
+	const uint32_t rounds = 100 * BENCH_ROUNDS;
+	double start, best = 0;
+	uintptr_t acc = 0;
+
+	for (uint32_t rep = 0; rep < BENCH_REPEATS; rep++) {
+		start = bench_now();
+		for (uint32_t r = 0; r < rounds; r++) {
+			acc += (uintptr_t)game_get_free_object(state, ASTEROID + r % N_TYPES);
+		}
+		best = bench_best(best, bench_now() - start);
+	}
+	benchSink = acc;
+	bench_report("game_get_free_object", n, rounds, best);
+	bench_free_state(state);
+}
+
+/* times handling all objects for a tick, with n objects in a
+ * game sized for maxObjs. Each repeat starts from the same state. */
+void bench_handle_objects(const char *name, uint32_t n, uint32_t maxObjs) {
+	double t, best = 0;
+
+	for (uint32_t rep = 0; rep < BENCH_REPEATS; rep++) {
+		GameState *state = bench_populate(n, maxObjs);
+		t = bench_now();
+		for (uint32_t r = 0; r < BENCH_ROUNDS; r++) {
+			game_handle_objects(state);
+		}
+		best = bench_best(best, bench_now() - t);
+		bench_free_state(state);
+	}
+	bench_report(name, n, BENCH_ROUNDS, best);
+}
+
+/* times each random_ function */
+void bench_random() {
+	const uint32_t rounds = 10000 * BENCH_ROUNDS;
+	const char *names[] = {
+		"random_next", "random_float", "random_prob", "random_uint32_t", "random_angle",
+	};
+	Random rng;
+	float acc = 0;
+
+	for (uint32_t f = 0; f < sizeof(names) / sizeof(names[0]); f++) {
+		double start, best = 0;
+		for (uint32_t rep = 0; rep < BENCH_REPEATS; rep++) {
+			random_seed(&rng, 1);
+			start = bench_now();
+			for (uint32_t r = 0; r < rounds; r++) {
+				switch (f) {
+					case 0: acc += random_next(&rng); break;
+					case 1: acc += random_float(&rng, 1.0); break;
+					case 2: acc += random_prob(&rng, 0.5); break;
+					case 3: acc += random_uint32_t(&rng, N_COLORS); break;
+					default: acc += random_angle(&rng); break;
+				}
+			}
+			best = bench_best(best, bench_now() - start);
+		}
+		bench_report(names[f], 1, rounds, best);
+	}
+	benchSink = acc;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *path = argc > 1 ? argv[1] : BENCH_DEFAULT_PATH;
+	SetTraceLogLevel(LOG_WARNING);
+
+	benchOut = fopen(path, "w");
+	if (benchOut == NULL) {
+		printf("couldn't open %s\n", path);
+		return 1;
+	}
+	fprintf(benchOut, "{\n  \"schema\": %u,\n  \"max_objs\": %u,\n  \"rounds\": %u,\n  \"repeats\": %u,\n  \"simd_width\": %u,\n  \"benchmarks\": [",
+			BENCH_SCHEMA, DEFAULT_MAX_OBJS, BENCH_ROUNDS, BENCH_REPEATS, COLLIDE_WIDTH);
+
+	bench_is_colliding_pairs();
+	bench_vector_rotate();
+	bench_line_intersection();
+	bench_random();
+	for (uint32_t n = 0; n < DEFAULT_MAX_OBJS; n += DEFAULT_MAX_OBJS / 4) {
+		bench_free_object(n);
+	}
+	for (uint32_t n = DEFAULT_MAX_OBJS / 4; n <= DEFAULT_MAX_OBJS; n += DEFAULT_MAX_OBJS / 4) {
+		bench_handle_objects("game_handle_objects", n, DEFAULT_MAX_OBJS);
+	}
+	//bigger games in bigger worlds, per tick time should grow with n, not faster.
+	for (uint32_t n = DEFAULT_MAX_OBJS; n <= BENCH_SCALED_MAX; n *= 2) {
+		bench_handle_objects("game_handle_objects_scaled", n, n);
+	}
+	for (uint32_t n = DEFAULT_MAX_OBJS / 4; n <= DEFAULT_MAX_OBJS; n += DEFAULT_MAX_OBJS / 4) {
+		bench_first_collider(n);
+	}
+	for (uint32_t n = 40; n <= DEFAULT_MAX_OBJS - DEFAULT_MAX_ASTEROIDS; n += 40) {
+		bench_collide_batch(n);
+	}
+
+	fprintf(benchOut, "\n  ]\n}\n");
+	fclose(benchOut);
+	printf("wrote %u benchmarks to %s\n", benchCount, path);
+	return 0;
+}
@@ -0,0 +1,53 @@
+/*
+ * Cameras for viewing worlds bigger than the window.
+ * A camera centers on a point, but never shows past the edge
+ * of the world, so in a world no bigger than the window it
+ * doesn't move at all.
+ * Cameras are raylib Camera2Ds with no offset, rotation or zoom,
+ * so target is the world position of the window's top left.
+ */
+#ifndef CAMERA_C
+#define CAMERA_C
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "types.h"
+#include "raylib.h"
+
+/* clamps v to [0, max]. 0 if max is negative. */
+float camera_clamp(float v, float max) {
+	if (v > max) {
+		v = max;
+	}
+	return v > 0 ? v : 0;
+}
+
+/* points cam at target, kept inside a worldW by worldH world. */
+void camera_follow(Camera2D *cam, Vector2 target, float worldW, float worldH) {
+	Vector2 zero = {0, 0};
+	cam->offset = zero;
+	cam->rotation = 0;
+	cam->zoom = 1.0f;
+	cam->target.x = camera_clamp(target.x - SCREEN_W / 2.0f, worldW - SCREEN_W);
+	cam->target.y = camera_clamp(target.y - SCREEN_H / 2.0f, worldH - SCREEN_H);
+}
+
+/* returns the part of the world cam shows, grown by margin on each side */
+Rectangle camera_view(Camera2D *cam, float margin) {
+	Rectangle view = {
+		cam->target.x - margin,
+		cam->target.y - margin,
+		SCREEN_W + 2 * margin,
+		SCREEN_H + 2 * margin,
+	};
+	return view;
+}
+
+/* true iff rec overlaps view */
+bool camera_is_visible(Rectangle view, Rectangle rec) {
+	return rec.x <= view.x + view.width && rec.x + rec.width >= view.x &&
+		rec.y <= view.y + view.height && rec.y + rec.height >= view.y;
+}
+
+#endif /* CAMERA_C */
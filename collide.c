@@ -0,0 +1,264 @@
+/*
+ * Batch collision tests between missiles and asteroids.
+ * Tests every missile in a CollideBatch against every asteroid,
+ * several asteroids at a time with SSE or AVX2, whichever the
+ * build targets, with a scalar loop for the rest.
+ * Gives the same results as object_is_colliding, in either order.
+ * NB: only bit identical if the scalar path isn't built with
+ * fused multiply-add, e.g. -ffp-contract=off with -mfma.
+ */
+#ifndef COLLIDE_C
+#define COLLIDE_C
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "types.h"
+#include "raylib.h"
+
+#include "arena.c"
+#include "object.c"
+#include "vector.c"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define COLLIDE_WIDTH 8
+typedef __m256 CollideVec;
+#define collide_set1 _mm256_set1_ps
+#define collide_load _mm256_loadu_ps
+#define collide_add _mm256_add_ps
+#define collide_sub _mm256_sub_ps
+#define collide_mul _mm256_mul_ps
+#define collide_div _mm256_div_ps
+#define collide_and _mm256_and_ps
+#define collide_or _mm256_or_ps
+#define collide_xor _mm256_xor_ps
+#define collide_ge(a, b) _mm256_cmp_ps(a, b, _CMP_GE_OQ)
+#define collide_le(a, b) _mm256_cmp_ps(a, b, _CMP_LE_OQ)
+#define collide_eq(a, b) _mm256_cmp_ps(a, b, _CMP_EQ_OQ)
+#define collide_mask _mm256_movemask_ps
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define COLLIDE_WIDTH 4
+typedef __m128 CollideVec;
+#define collide_set1 _mm_set1_ps
+#define collide_load _mm_loadu_ps
+#define collide_add _mm_add_ps
+#define collide_sub _mm_sub_ps
+#define collide_mul _mm_mul_ps
+#define collide_div _mm_div_ps
+#define collide_and _mm_and_ps
+#define collide_or _mm_or_ps
+#define collide_xor _mm_xor_ps
+#define collide_ge _mm_cmpge_ps
+#define collide_le _mm_cmple_ps
+#define collide_eq _mm_cmpeq_ps
+#define collide_mask _mm_movemask_ps
+#else
+#define COLLIDE_WIDTH 1 //no vector unit, everything goes through the scalar loop
+#endif
+
+/* carves columns for up to capacity missiles and asteroids from arena */
+void collide_init(CollideBatch *b, Arena *arena, uint32_t capacity) {
+	b->capacity = capacity;
+	b->mx = arena_alloc(arena, capacity * sizeof(float));
+	b->my = arena_alloc(arena, capacity * sizeof(float));
+	b->mpx = arena_alloc(arena, capacity * sizeof(float));
+	b->mpy = arena_alloc(arena, capacity * sizeof(float));
+	b->missiles = arena_alloc(arena, capacity * sizeof(uint16_t));
+	b->ax0 = arena_alloc(arena, capacity * sizeof(float));
+	b->ay0 = arena_alloc(arena, capacity * sizeof(float));
+	b->ax1 = arena_alloc(arena, capacity * sizeof(float));
+	b->ay1 = arena_alloc(arena, capacity * sizeof(float));
+	b->asteroids = arena_alloc(arena, capacity * sizeof(uint16_t));
+}
+
+/* empties batch */
+void collide_clear(CollideBatch *b) {
+	b->nMissiles = 0;
+	b->nAsteroids = 0;
+}
+
+/* adds missile obj to batch */
+void collide_add_missile(CollideBatch *b, Object *obj) {
+	uint32_t i = b->nMissiles++;
+	Vector2 prev = object_movement(obj, true);
+	b->mx[i] = object_x(obj);
+	b->my[i] = object_y(obj);
+	b->mpx[i] = prev.x;
+	b->mpy[i] = prev.y;
+	b->missiles[i] = obj->id;
+}
+
+/* adds asteroid obj to batch */
+void collide_add_asteroid(CollideBatch *b, Object *obj) {
+	uint32_t j = b->nAsteroids++;
+	b->ax0[j] = object_x(obj);
+	b->ay0[j] = object_y(obj);
+	b->ax1[j] = object_x(obj) + obj->w;
+	b->ay1[j] = object_y(obj) + obj->h;
+	b->asteroids[j] = obj->id;
+}
+
+/* fills batch with all active missiles and asteroids in state */
+void collide_gather(CollideBatch *b, ObjectStore *store, Object *objs) {
+	collide_clear(b);
+	for (uint32_t k = 0; k < store_n_live(store); k++) {
+		Object *obj = &objs[store_live(store, k)];
+		if (object_is_type(obj, MISSILE)) {
+			collide_add_missile(b, obj);
+		} else if (object_is_type(obj, ASTEROID)) {
+			collide_add_asteroid(b, obj);
+		}
+	}
+}
+
+/*
+ * Scalar test of missile i against asteroid j.
+ * missileFirst tests like object_is_colliding(missile, asteroid):
+ * the missile's point in the asteroid's box.
+ * Otherwise like object_is_colliding(asteroid, missile):
+ * a corner on the missile, or an edge crossing its path.
+ */
+bool collide_pair(CollideBatch *b, uint32_t i, uint32_t j, bool missileFirst) {
+	Vector2 missile = {b->mx[i], b->my[i]};
+	Vector2 prevPos = {b->mpx[i], b->mpy[i]};
+	Vector2 corners[4] = {
+		{b->ax0[j], b->ay0[j]},
+		{b->ax1[j], b->ay0[j]},
+		{b->ax1[j], b->ay1[j]},
+		{b->ax0[j], b->ay1[j]},
+	};
+
+	if (missileFirst) {
+		//same as CheckCollisionPointRec, edges included.
+		return missile.x >= b->ax0[j] && missile.x <= b->ax1[j] &&
+			missile.y >= b->ay0[j] && missile.y <= b->ay1[j];
+	}
+
+	//bounds check, see object_is_bounds_overlapping
+	if (fminf(missile.x, prevPos.x) > b->ax1[j] || fmaxf(missile.x, prevPos.x) < b->ax0[j] ||
+			fminf(missile.y, prevPos.y) > b->ay1[j] || fmaxf(missile.y, prevPos.y) < b->ay0[j]) {
+		return false;
+	}
+
+	Vector2 prev = corners[3];
+	for (uint32_t k = 0; k < 4; k++) {
+		if (vector_is_equal(corners[k], missile) ||
+				vector_is_line_colliding(prev, corners[k], missile, prevPos)) {
+			return true;
+		}
+		prev = corners[k];
+	}
+	return false;
+}
+
+#if COLLIDE_WIDTH > 1
+/* true lanes where edge (p0, p1) crosses missile path (m, mp).
+ * Same operations in the same order as vector_get_line_intersection,
+ * so results match it exactly. */
+CollideVec collide_edge(CollideVec p0x, CollideVec p0y, CollideVec p1x, CollideVec p1y,
+		CollideVec mx, CollideVec my, CollideVec s2x, CollideVec s2y) {
+	const CollideVec zero = collide_set1(0.0f);
+	const CollideVec one = collide_set1(1.0f);
+	const CollideVec sign = collide_set1(-0.0f);
+
+	CollideVec s1x = collide_sub(p1x, p0x);
+	CollideVec s1y = collide_sub(p1y, p0y);
+	CollideVec dx = collide_sub(p0x, mx);
+	CollideVec dy = collide_sub(p0y, my);
+	CollideVec den = collide_add(
+			collide_mul(collide_xor(s2x, sign), s1y),
+			collide_mul(s1x, s2y));
+	CollideVec s = collide_div(collide_add(
+				collide_mul(collide_xor(s1y, sign), dx),
+				collide_mul(s1x, dy)), den);
+	CollideVec t = collide_div(collide_sub(
+				collide_mul(s2x, dy),
+				collide_mul(s2y, dx)), den);
+
+	return collide_and(
+			collide_and(collide_ge(s, zero), collide_le(s, one)),
+			collide_and(collide_ge(t, zero), collide_le(t, one)));
+}
+
+/* tests missile i against COLLIDE_WIDTH asteroids from j on.
+ * returns a bit per asteroid, set if they collide. */
+uint32_t collide_lanes(CollideBatch *b, uint32_t i, uint32_t j, bool missileFirst) {
+	CollideVec mx = collide_set1(b->mx[i]);
+	CollideVec my = collide_set1(b->my[i]);
+	CollideVec x0 = collide_load(&b->ax0[j]);
+	CollideVec y0 = collide_load(&b->ay0[j]);
+	CollideVec x1 = collide_load(&b->ax1[j]);
+	CollideVec y1 = collide_load(&b->ay1[j]);
+
+	if (missileFirst) {
+		return collide_mask(collide_and(
+				collide_and(collide_ge(mx, x0), collide_le(mx, x1)),
+				collide_and(collide_ge(my, y0), collide_le(my, y1))));
+	}
+
+	//bounds check, see object_is_bounds_overlapping. Most lanes stop here.
+	CollideVec lox = collide_set1(fminf(b->mx[i], b->mpx[i]));
+	CollideVec hix = collide_set1(fmaxf(b->mx[i], b->mpx[i]));
+	CollideVec loy = collide_set1(fminf(b->my[i], b->mpy[i]));
+	CollideVec hiy = collide_set1(fmaxf(b->my[i], b->mpy[i]));
+	CollideVec overlap = collide_and(
+			collide_and(collide_le(lox, x1), collide_ge(hix, x0)),
+			collide_and(collide_le(loy, y1), collide_ge(hiy, y0)));
+	if (collide_mask(overlap) == 0) {
+		return 0;
+	}
+
+	CollideVec s2x = collide_set1(b->mpx[i] - b->mx[i]);
+	CollideVec s2y = collide_set1(b->mpy[i] - b->my[i]);
+	CollideVec hit = collide_and(
+			collide_or(collide_eq(x0, mx), collide_eq(x1, mx)),
+			collide_or(collide_eq(y0, my), collide_eq(y1, my)));
+	hit = collide_or(hit, collide_edge(x0, y1, x0, y0, mx, my, s2x, s2y));
+	hit = collide_or(hit, collide_edge(x0, y0, x1, y0, mx, my, s2x, s2y));
+	hit = collide_or(hit, collide_edge(x1, y0, x1, y1, mx, my, s2x, s2y));
+	hit = collide_or(hit, collide_edge(x1, y1, x0, y1, mx, my, s2x, s2y));
+	return collide_mask(collide_and(hit, overlap));
+}
+#endif
+
+/*
+ * Tests all missiles against all asteroids in batch.
+ * hits must fit nMissiles * nAsteroids entries, and is set
+ * row by row: hits[i * nAsteroids + j] is true iff missile i
+ * collides with asteroid j. See collide_pair for missileFirst.
+ */
+void collide_batch(CollideBatch *b, bool missileFirst, bool *hits) {
+	uint32_t m = b->nAsteroids;
+
+	for (uint32_t i = 0; i < b->nMissiles; i++) {
+		bool *row = &hits[i * m];
+		uint32_t j = 0;
+#if COLLIDE_WIDTH > 1
+		for (; j + COLLIDE_WIDTH <= m; j += COLLIDE_WIDTH) {
+			uint32_t mask = collide_lanes(b, i, j, missileFirst);
+			for (uint32_t k = 0; k < COLLIDE_WIDTH; k++) {
+				row[j + k] = (mask >> k) & 1;
+			}
+		}
+#endif
+		for (; j < m; j++) {
+			row[j] = collide_pair(b, i, j, missileFirst);
+		}
+	}
+}
+
+/* same as collide_batch, one pair at a time. Used to check it. */
+void collide_batch_scalar(CollideBatch *b, bool missileFirst, bool *hits) {
+	uint32_t m = b->nAsteroids;
+
+	for (uint32_t i = 0; i < b->nMissiles; i++) {
+		for (uint32_t j = 0; j < m; j++) {
+			hits[i * m + j] = collide_pair(b, i, j, missileFirst);
+		}
+	}
+}
+
+#endif /* COLLIDE_C */
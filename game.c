@@ -10,54 +10,220 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "types.h"
+#include "arena.c"
+#include "camera.c"
 #include "object.c"
 #include "player.c"
+#include "grid.c"
+#include "guestmap.c"
+#include "profile.c"
+#include "record.c"
+#include "render.c"
+#include "text.c"
 
 /* INIT */
 
-/* initilaizes game and raylib */
-void game_init(GameState *state) {
+/* fills in defaults for limits that weren't set */
+void game_init_limits(GameState *state) {
+	Limits *limits = &state->limits;
+	if (limits->maxObjs == 0) { limits->maxObjs = DEFAULT_MAX_OBJS; }
+	if (limits->maxPlayers == 0) { limits->maxPlayers = DEFAULT_MAX_PLAYERS; }
+	if (limits->maxAsteroids == 0) { limits->maxAsteroids = DEFAULT_MAX_ASTEROIDS; }
+	if (limits->worldW == 0) { limits->worldW = DEFAULT_WORLD_W; }
+	if (limits->worldH == 0) { limits->worldH = DEFAULT_WORLD_H; }
+}
+
+/* true iff limits are ones the game can run with. Logs why not. */
+bool game_is_limits_valid(Limits *limits) {
+	if (limits->maxPlayers > PLAYERS_LIMIT) {
+		ILOG("at most %u players", PLAYERS_LIMIT);
+		return false;
+	}
+	if (limits->maxObjs > OBJS_LIMIT || limits->maxObjs <= limits->maxPlayers) {
+		ILOG("objects must be more than players, and at most %u", OBJS_LIMIT);
+		return false;
+	}
+	if (limits->maxAsteroids < N_START_ASTEROIDS + 2) {
+		ILOG("at least %u asteroids", N_START_ASTEROIDS + 2);
+		return false;
+	}
+	if (limits->worldW < WORLD_MIN || limits->worldW > WORLD_LIMIT ||
+			limits->worldH < WORLD_MIN || limits->worldH > WORLD_LIMIT) {
+		ILOG("world sides must be between %u and %u", WORLD_MIN, WORLD_LIMIT);
+		return false;
+	}
+	return true;
+}
+
+/* carves everything sized by limits from arena.
+ * Only sets pointers, so it can be run on an arena that just counts. */
+void game_carve(GameState *state, Arena *arena) {
+	Limits *limits = &state->limits;
+	state->players = arena_alloc(arena, limits->maxPlayers * sizeof(Player));
+	state->objs = arena_alloc(arena, limits->maxObjs * sizeof(Object));
+	state->candidates = arena_alloc(arena, limits->maxObjs * sizeof(uint16_t));
+	store_init(&state->store, arena, limits);
+	grid_init(&state->grid, arena, limits);
+	record_init(&state->recorder, arena, limits);
+	render_init(&state->renderer, arena, limits);
+	guestmap_init(&state->guests, arena, limits);
+	state->inputs = arena_alloc(arena, limits->maxPlayers * sizeof(uint32_t));
+	state->scoreTexts = arena_alloc(arena, limits->maxPlayers * sizeof(CachedText));
+}
+
+/* allocates players and objects sized by state's limits,
+ * and binds objects to their slots in the object store.
+ * returns true on failure, false otherwise. */
+bool game_init_objects(GameState *state) {
+	Arena counter = { 0 };
+
+	game_init_limits(state);
+	game_carve(state, &counter);
+	if (arena_init(&state->arena, arena_used(&counter))) {
+		return true;
+	}
+	game_carve(state, &state->arena);
+	ILOG("allocated %zu bytes for %u objects and %u players",
+			arena_used(&state->arena), state->limits.maxObjs, state->limits.maxPlayers);
+
+	for (uint32_t i = 0; i < state->limits.maxObjs; i++) {
+		object_bind(&state->objs[i], &state->store, i);
+	}
+	return false;
+}
+
+/* seeds game randomness, based on time if no seed was given */
+void game_init_random(GameState *state) {
+	if (!state->seeded) {
+		state->seed = random_time_seed();
+	}
+	ILOG("random seed: %llu", (unsigned long long)state->seed);
+	random_seed(&state->rng, state->seed);
+}
+
+/* initilaizes game and raylib. Doesn't open a window if headless.
+ * returns true on failure, false otherwise. */
+bool game_init(GameState *state) {
+	if (game_init_objects(state)) {
+		return true;
+	}
 	SetTraceLogLevel(LOG_WARNING);
-	random_seed();
-	InitWindow(SCREEN_W, SCREEN_H, GAME_NAME);
-	SetTargetFPS(FPS);
+	game_init_random(state);
+	if (state->recordPath != NULL && record_open(&state->recorder, state->recordPath, state->seed,
+				state->store.swept ? RECORD_SWEPT : 0, &state->limits)) {
+		arena_free(&state->arena);
+		return true;
+	}
+	if (!state->headless) {
+		state->renderer.batched = true;
+		InitWindow(SCREEN_W, SCREEN_H, GAME_NAME);
+		SetTargetFPS(RENDER_FPS);
+		state->frame = LoadRenderTexture(SCREEN_W, SCREEN_H);
+	}
+	return false;
+}
+
+/*
+ * reads options following the session from args into state.
+ * returns false if an option isn't recognized, limits are invalid,
+ * or an option a replay takes from its recording is given with it.
+ */
+bool game_parse_options(GameState *state, int argc, char *argv[]) {
+	bool recorded = false; //an option replays take from the recording was given
+	for (int i = 0; i < argc; i++) {
+		if (strcmp(argv[i], HEADLESS_OPTION) == 0) {
+			state->headless = true;
+			if (i + 1 < argc) {
+				state->tickLimit = strtoull(argv[++i], NULL, 10);
+			}
+		} else if (strcmp(argv[i], PROFILE_OPTION) == 0 && i + 1 < argc) {
+			state->profilePath = argv[++i];
+		} else if (strcmp(argv[i], SEED_OPTION) == 0 && i + 1 < argc) {
+			state->seed = strtoull(argv[++i], NULL, 10);
+			state->seeded = true;
+			recorded = true;
+		} else if (strcmp(argv[i], SWEPT_OPTION) == 0) {
+			state->store.swept = true;
+			recorded = true;
+		} else if (strcmp(argv[i], OBJECTS_OPTION) == 0 && i + 1 < argc) {
+			state->limits.maxObjs = strtoul(argv[++i], NULL, 10);
+			recorded = true;
+		} else if (strcmp(argv[i], PLAYERS_OPTION) == 0 && i + 1 < argc) {
+			state->limits.maxPlayers = strtoul(argv[++i], NULL, 10);
+			recorded = true;
+		} else if (strcmp(argv[i], ASTEROIDS_OPTION) == 0 && i + 1 < argc) {
+			state->limits.maxAsteroids = strtoul(argv[++i], NULL, 10);
+			recorded = true;
+		} else if (strcmp(argv[i], WORLD_OPTION) == 0 && i + 1 < argc) {
+			recorded = true;
+			if (sscanf(argv[++i], "%ux%u", &state->limits.worldW, &state->limits.worldH) != 2) {
+				ILOG("world size must be WxH, not %s", argv[i]);
+				return false;
+			}
+		} else if (strcmp(argv[i], RECORD_OPTION) == 0 && i + 1 < argc) {
+			state->recordPath = argv[++i];
+		} else if (strcmp(argv[i], REPLAY_OPTION) == 0 && i + 1 < argc) {
+			//replays use the recorded seed, settings and limits, and run until the recording ends.
+			uint32_t flags;
+			if (record_open_replay(&state->recorder, argv[++i], &state->seed, &flags, &state->limits)) {
+				return false;
+			}
+			state->store.swept = flags & RECORD_SWEPT;
+			state->seeded = true;
+			state->headless = true;
+		} else {
+			ILOG("unknown option %s", argv[i]);
+			return false;
+		}
+	}
+	//these would override the recording, in whichever order, and the replay would diverge.
+	if (recorded && record_is_replaying(&state->recorder)) {
+		ILOG("replays use the recorded seed, %s and limits, they can't be given too", SWEPT_OPTION);
+		return false;
+	}
+	game_init_limits(state);
+	return game_is_limits_valid(&state->limits);
 }
 
 /** GETTERS **/
 
 /* returns number of active players */
 uint32_t game_get_n_players(GameState *state) {
-	uint32_t res = 0;
-	for (uint32_t i = 0; i < MAX_PLAYERS; i++) {
-		if (player_is_active(&state->players[i])) { res++; }
-	}
-	return res;
+	return state->nPlayers;
 }
 
 /* returns active objects of type type */
 uint32_t game_get_n_objects(GameState *state, uint32_t type) {
-	uint32_t res = 0;
-	for (uint32_t i = 0; i < MAX_OBJS; i++) {
-		Object *obj = &state->objs[i];
-		if (object_is_active(obj) && object_is_type(obj, type)) {
-			res += 1;
-		}
+	return store_n_type(&state->store, type);
+}
+
+/* returns how many players and objects there are, by type and state */
+GameStats game_get_stats(GameState *state) {
+	GameStats stats = { 0 };
+	stats.nPlayers = game_get_n_players(state);
+	stats.nLive = store_n_live(&state->store);
+	stats.capacity = state->store.capacity;
+	for (uint32_t t = 1; t <= N_TYPES; t++) {
+		stats.nType[t] = store_n_type(&state->store, t);
+		stats.nDestroyed[t] = store_n_destroyed(&state->store, t);
 	}
-	return res;
+	return stats;
 }
 
 /* gets player from a parsec guest. NULL if no match. */
 Player* game_get_player_from_guest(GameState *state, ParsecGuest *guest) {
-	for (uint32_t i = 0; i < MAX_PLAYERS; i++) {
-		Player *player = &state->players[i];
-		if (player_is_active(&state->players[i]) &&
-				player_is_guest(&state->players[i], guest)) {
-			return &state->players[i];
-		}
+	int32_t slot = guestmap_find(&state->guests, guest->id);
+	if (slot < 0) {
+		return NULL;
 	}
-	return NULL;
+	Player *p = &state->players[slot];
+	if (!player_is_active(p) || !player_is_guest(p, guest)) {
+		return NULL;
+	}
+	return p;
 }
 
 /* returns local player. */
@@ -65,32 +231,30 @@ Player* game_get_local_player(GameState *state) {
 	return state->localPlayer;
 }
 
-/* returns player from an object.
- * NULL if object belongs to no player.
+/* returns handle for p, to be stored as an object's owner.
+ * Handle is slot and generation, so it doesn't match whoever
+ * takes the slot after p leaves. */
+uint32_t game_player_handle(GameState *state, Player *p) {
+	return (uint32_t)p->generation << 16 | (uint32_t)(p - state->players);
+}
+
+/* returns player from an object, by its owner handle.
+ * NULL if object belongs to no player, or one that left.
  */
 Player* game_get_player_from_object(GameState *state, Object *obj) {
-	if (obj == NULL) {
+	if (obj == NULL || object_owner(obj) == OBJECT_NO_OWNER) {
 		return NULL;
 	}
-	if (object_is_type(obj, SHIP)) {
-		for (uint32_t i = 0; i < MAX_PLAYERS; i++) {
-			Player *player = &state->players[i];
-			if (player_ship(player) == obj) {
-				return player;
-			}
-		}
+	uint32_t slot = object_owner(obj) & 0xffff;
+	uint32_t generation = object_owner(obj) >> 16;
+	if (slot >= state->limits.maxPlayers) {
+		return NULL;
 	}
-	//Missiles belong to users if they are same color.
-	//Hacky, so should have a better system.
-	if (object_is_type(obj, MISSILE)) {
-		for (uint32_t i = 0; i < MAX_PLAYERS; i++) {
-			Player *player = &state->players[i];
-			if (color_is_equal(player_color(player), object_color(obj))) {
-				return player;
-			}
-		}
+	Player *p = &state->players[slot];
+	if (!player_is_active(p) || p->generation != generation) {
+		return NULL;
 	}
-	return NULL;
+	return p;
 }
 
 /** CHECKS **/
@@ -100,7 +264,7 @@ Player* game_get_player_from_object(GameState *state, Object *obj) {
  */
 bool game_is_object_in_cooldown(GameState *state, Object *obj, uint64_t cooldown) {
 	uint64_t now = state->framecounter;
-	int diff = now - obj->framecounter;
+	uint64_t diff = now - obj->framecounter;
 	//NB first check handles overflow of uint in global frame counter
 	return !(now < obj->framecounter || diff > cooldown);
 }
@@ -114,6 +278,23 @@ bool game_is_newly_spawned_missile(GameState *state, Object *obj) {
 	return object_is_type(obj, MISSILE) && game_is_object_in_cooldown(state, obj, 1);
 }
 
+/* true iff no more objects of type can be added. */
+bool game_is_object_pool_exhausted(GameState *state, uint32_t type) {
+	return !store_can_alloc(&state->store, type);
+}
+
+/* true iff game loop should stop, e.g. the window was closed,
+ * or a headless game has run all its ticks. */
+bool game_should_close(GameState *state) {
+	if (record_is_replaying(&state->recorder) && record_is_done(&state->recorder, state->ticks)) {
+		return true;
+	}
+	if (state->headless) {
+		return state->tickLimit > 0 && state->ticks >= state->tickLimit;
+	}
+	return WindowShouldClose();
+}
+
 /* true iff there is a local player who is active. */
 bool game_is_local_player_active(GameState *state) {
 	Player *p = game_get_local_player(state);
@@ -122,41 +303,77 @@ bool game_is_local_player_active(GameState *state) {
 
 /** GAME OBJECT GETTERS **/
 
+/* true iff o collides with oj in a way that counts,
+ * e.g. excluding missiles that were just launched. */
+bool game_is_colliding(GameState *state, Object *o, Object *oj) {
+	if (o == oj || oj == NULL || !object_is_active(oj)) {
+		return false;
+	}
+	if (!object_is_colliding(o, oj) &&
+			!(state->store.swept && object_is_sweep_colliding(o, oj))) {
+		return false;
+	}
+	if (game_is_newly_spawned_missile(state, o) ||
+			game_is_newly_spawned_missile(state, oj)) {
+		DLOG("newly spawned");
+		return false;
+	}
+	return true;
+}
+
 /* Iterates over active objects and finds first collider with o.
+ * NULL if no collision. Used when the grid isn't built.
+ */
+Object* game_scan_first_collider(GameState *state, Object *o) {
+	for (uint32_t k = 0; k < store_n_live(&state->store); k++) {
+		Object *oj = &state->objs[store_live(&state->store, k)];
+		if (game_is_colliding(state, o, oj)) {
+			return oj;
+		}
+	}
+	return NULL;
+}
+
+/* Finds first collider with o, e.g. the colliding object
+ * with the lowest index. Only checks objects near o
+ * if the grid is built, otherwise scans all objects.
  * NULL if no collision.
  */
 Object* game_get_first_collider(GameState *state, Object *o) {
-	for (uint32_t j = 0; j < MAX_OBJS; j++) {
-		Object *oj = &state->objs[j];
-		if (o != oj && oj != NULL && object_is_active(oj)) {
-			if (object_is_colliding(o, oj)) {
-				if (game_is_newly_spawned_missile(state, o) ||
-						game_is_newly_spawned_missile(state, oj)) {
-					DLOG("newly spawned");
-				} else {
-					return oj;
-				}
-			}
+	uint16_t *candidates = state->candidates;
+	Object *first = NULL;
+
+	if (!state->grid.valid) {
+		return game_scan_first_collider(state, o);
+	}
+	if (!object_is_active(o)) {
+		return NULL;
+	}
+
+	uint32_t n = grid_query(&state->grid, o, candidates);
+	for (uint32_t k = 0; k < n; k++) {
+		Object *oj = &state->objs[candidates[k]];
+		if ((first == NULL || oj < first) && game_is_colliding(state, o, oj)) {
+			first = oj;
 		}
 	}
-	return NULL;
+	return first;
 }
 
 /*
- * returns a 0 initialized game object from the state.
- * NULL if no objects available.
+ * returns a 0 initialized game object from the state,
+ * to be used for an object of type.
+ * NULL if no objects available for that type, see
+ * game_is_object_pool_exhausted.
  */
-Object* game_get_free_object(GameState *state) {
-	Object *obj, *ref = NULL;
-
-	for (uint32_t i = 0; i < MAX_OBJS; i++) {
-		ref = &state->objs[i];
-		if (!object_is_active(ref)) {
-			obj = ref;
-			object_clear(obj);
-			break;
-		}
+Object* game_get_free_object(GameState *state, uint32_t type) {
+	int32_t id = store_alloc(&state->store, type);
+	if (id < 0) {
+		DLOG("object pool exhausted for type %d", type);
+		return NULL;
 	}
+	Object *obj = &state->objs[id];
+	object_clear(obj);
 	return obj;
 }
 
@@ -174,7 +391,7 @@ Object* game_place_object(GameState *state, Object *obj, uint32_t type, Color co
 	const uint32_t maxTries = 100;
 
 	for (uint32_t i = 0; i < maxTries; i++) {
-		obj = object_activate(obj, type, col);
+		obj = object_activate(obj, &state->rng, type, col);
 		if (obj == NULL) {
 			break;
 		}
@@ -192,7 +409,7 @@ Object* game_place_object(GameState *state, Object *obj, uint32_t type, Color co
  * Adds a new object to the game of type type.
  */
 Object* game_add_object(GameState *state, uint32_t type, Color col) {
-	return game_place_object(state, game_get_free_object(state), type, col);
+	return game_place_object(state, game_get_free_object(state, type), type, col);
 }
 
 /* Adds a missile from a ship.
@@ -201,7 +418,7 @@ Object* game_add_object(GameState *state, uint32_t type, Color col) {
  */
 Object *game_add_missile(GameState *state, Object *ship) {
 	Object *obj = NULL;
-	obj = game_get_free_object(state);
+	obj = game_get_free_object(state, MISSILE);
 	Player *p = game_get_player_from_object(state, ship);
 
 	if (obj == NULL) {
@@ -226,54 +443,67 @@ Object *game_add_missile(GameState *state, Object *ship) {
 									vector_scale(missileDirection, scaling));
 
 	object_init(obj, MISSILE, object_speed(ship) + MISSILE_SPEED, missileDirection, MISSILE_SIZE, pos, 0, player_color(p));
+	object_set_owner(obj, object_owner(ship));
 	obj->framecounter = state->framecounter;
 
 	return obj;
 }
 
-/* assigns a new color to dst. returns NULL and does no assignment if colors have run out */
-bool game_new_player_color(GameState *state, Player *p) {
+/* picks a color for a new player, from COLORS while there are
+ * free ones, then random hues. */
+Color game_random_player_color(GameState *state, uint32_t nPlayers) {
+	if (nPlayers < N_COLORS) {
+		return COLORS[random_uint32_t(&state->rng, N_COLORS)];
+	}
+	return ColorFromHSV(random_float(&state->rng, 360.0f), 0.6f, 1.0f);
+}
+
+/* assigns a new color to p, one no other player has if one is found.
+ * Colors are only for telling players apart, ownership goes by handle,
+ * so sharing one is allowed. */
+void game_new_player_color(GameState *state, Player *p) {
 	uint32_t nPlayers = game_get_n_players(state);
 	uint32_t maxTries = 100;
-	if (nPlayers >= N_COLORS) {
-		return false;
-	}
 	for (uint32_t i = 0; i < maxTries; i++) {
-		Color col = COLORS[random_uint32_t(N_COLORS)];
+		Color col = game_random_player_color(state, nPlayers);
+		player_set_color(p, col);
 		uint32_t i = 0;
-		for (; i < MAX_PLAYERS; i++) {
+		for (; i < state->limits.maxPlayers; i++) {
 			Player *thisP = &state->players[i];
 			if (p != thisP && player_is_active(thisP) && color_is_equal(player_color(thisP), col)) {
 				break;
 			}
 		}
-		if (i == MAX_PLAYERS) { //successfully iterated through all players, color found
-			player_set_color(p, col);
-			return true;
+		if (i == state->limits.maxPlayers) { //successfully iterated through all players, color found
+			return;
 		}
 	}
-	return false;
+	DLOG("no free player color, sharing one");
 }
 
 /* Adds a player */
 Player* game_add_player(GameState *state, ParsecGuest *guest) {
-	for (uint32_t i = 0; i < MAX_PLAYERS; i++) {
+	for (uint32_t i = 0; i < state->limits.maxPlayers; i++) {
 		Player *p = &state->players[i];
 		if (!player_is_active(p)) {
-			player_clear(p);
+			player_renew(p);
 			if (guest != NULL) {
 				player_set_guest(p, guest);
 			}
-			if (!game_new_player_color(state, p)) {
-				DLOG("Couldn't assign player color");
-				return NULL;
-			}
+			//recorded even if adding fails, since failing still uses randomness.
+			record_join(&state->recorder, state->ticks, i, guest != NULL ? guest->id : 0);
+			game_new_player_color(state, p);
 			Object *ship = game_add_object(state, SHIP, player_color(p));
 			if (ship == NULL) {
 				DLOG("couldn't allocate ship for player");
 				return NULL;
 			}
+			object_set_owner(ship, game_player_handle(state, p));
 			player_activate(p, ship);
+			state->nPlayers++;
+			if (guest != NULL) {
+				guestmap_insert(&state->guests, guest->id, i);
+			}
 
 			return &(state->players[i]); }
 	}
@@ -285,6 +515,11 @@ bool game_remove_player(GameState *state, Player *p) {
 	if (p == NULL) {
 		return false;
 	}
+	record_leave(&state->recorder, state->ticks, p - state->players);
+	if (player_is_active(p)) {
+		state->nPlayers--;
+		guestmap_remove(&state->guests, p->guest.id, p - state->players);
+	}
 	object_deactivate(player_ship(p));
 	player_deactivate(p);
 	return true;
@@ -295,7 +530,6 @@ bool game_remove_player(GameState *state, Player *p) {
  * Adjusts score based on collider.
  */
 void game_destroy_object(GameState *state, Object *obj, Object *collider) {
-	uint32_t amount = 0;
 	Player *p = game_get_player_from_object(state, obj);
 	if (!object_destroy(obj)) {
 		return;
@@ -320,11 +554,15 @@ void game_destroy_object(GameState *state, Object *obj, Object *collider) {
 /** GAME HANDLERS **/
 
 /* advances objects and checks collisions.
- * We do a bunch of double loops here, but
- * game is small it won't matter. */
+ * Grid is built up front and kept up to date as objects
+ * move, so collision checks only look at nearby objects. */
 void game_handle_objects(GameState *state) {
-	Player *p;
-	for (uint32_t i = 0; i < MAX_OBJS; i++) {
+	ObjectStore *store = &state->store;
+	grid_build(&state->grid, store, state->objs);
+
+	//NB: nothing here (de)activates objects, so the live list doesn't change under us.
+	for (uint32_t k = 0; k < store_n_live(store); k++) {
+		uint32_t i = store_live(store, k);
 		Object *oi = &state->objs[i];
 		Object *oj = game_get_first_collider(state, oi);
 
@@ -346,99 +584,135 @@ void game_handle_objects(GameState *state) {
 			object_debug(oi, "respawning");
 			game_place_object(state, oi, SHIP, object_color(oi));
 		}
+
+		grid_update(&state->grid, state->objs, i);
 	}
+
+	grid_invalidate(&state->grid);
 }
 
-/* adjusts ship state based on action. */
-void game_handle_ship_action(GameState *state, Object *obj, ShipAction action) {
-	if (obj == NULL) {
-		ILOG("null ship");
-		return;
+/*
+ * applies input, as PRESS_ bits, to ship.
+ * Speed, then turning, then shooting, same as always,
+ * so recorded games replay the same.
+ */
+void game_apply_input(GameState *state, Object *ship, uint32_t input) {
+	const uint32_t speedUp = PRESS_W | PRESS_UP | PRESS_G_UP | PRESS_G_A;
+	const uint32_t speedDown = PRESS_S | PRESS_DOWN | PRESS_G_DOWN | PRESS_G_B;
+	const uint32_t turnLeft = PRESS_A | PRESS_LEFT | PRESS_G_LEFT;
+	const uint32_t turnRight = PRESS_D | PRESS_RIGHT | PRESS_G_RIGHT;
+	const uint32_t shoot = PRESS_SPACE | PRESS_G_X;
+
+	if (input & speedUp) {
+		object_adjust_speed(ship, SHIP_SPEED_ADJUSTMENT);
+	}
+	if (input & speedDown) {
+		object_adjust_speed(ship, -SHIP_SPEED_ADJUSTMENT);
+	}
+	if (input & turnLeft) {
+		object_adjust_direction(ship, -SHIP_ANGLE_ADJUSTMENT);
+	}
+	if (input & turnRight) {
+		object_adjust_direction(ship, SHIP_ANGLE_ADJUSTMENT);
 	}
-	object_debug(obj, "pre-action");
+	if ((input & shoot) && !game_is_object_in_cooldown(state, ship, SHIP_MISSILE_COOLDOWN)) {
+		game_add_missile(state, ship);
+		ship->framecounter = state->framecounter;
+	}
+}
 
-	switch (action) {
-		case TURN_LEFT:
-			DLOG("turning left %f", -SHIP_ANGLE_ADJUSTMENT);
-			object_debug(obj, "pre-left");
-			object_adjust_direction(obj, -SHIP_ANGLE_ADJUSTMENT);
-			object_debug(obj, "post-left");
-			break;
-		case TURN_RIGHT:
-			DLOG("turning right");
-			object_adjust_direction(obj, SHIP_ANGLE_ADJUSTMENT);
-			break;
-		case SPEED_UP:
-			DLOG("speeding up");
-			object_adjust_speed(obj, SHIP_SPEED_ADJUSTMENT);
-			break;
-		case SPEED_DOWN:
-			DLOG("speeding down");
-			object_adjust_speed(obj, -SHIP_SPEED_ADJUSTMENT);
+/* copies presses of every player slot into inputs, 0 for inactive
+ * slots. The tick records and applies these, so input arriving
+ * while it runs waits for the next one. */
+void game_snapshot_inputs(GameState *state) {
+	for (uint32_t i = 0; i < state->limits.maxPlayers; i++) {
+		Player *p = &state->players[i];
+		state->inputs[i] = player_is_active(p) ? player_get_presses(p) : 0;
+	}
+}
+
+/* applies this tick's inputs to all ships, in one pass */
+void game_handle_players(GameState *state) {
+	for (uint32_t i = 0; i < state->limits.maxPlayers; i++) {
+		uint32_t input = state->inputs[i];
+		Object *ship = player_ship(&state->players[i]);
+		if (input != 0 && ship != NULL) {
+			game_apply_input(state, ship, input);
+		}
+	}
+}
+
+/* applies a replayed event to players.
+ * returns true on failure (event is for a slot there is no player for), false otherwise. */
+bool game_replay_event(GameState *state, RecordEvent *ev) {
+	if (ev->slot >= state->limits.maxPlayers) {
+		ILOG("replay event for player %u, but only %u players", ev->slot, state->limits.maxPlayers);
+		return true;
+	}
+	Player *p = &state->players[ev->slot];
+	ParsecGuest guest = { 0 };
+
+	switch (ev->type) {
+		case RECORD_JOIN:
+			guest.id = ev->value;
+			p = game_add_player(state, ev->value != 0 ? &guest : NULL);
+			if (p != NULL && p != &state->players[ev->slot]) {
+				ILOG("replay diverged: player %u joined in wrong slot", ev->slot);
+			}
+			if (ev->value == 0) {
+				state->localPlayer = p;
+			}
 			break;
-		case SHOOT:
-			if (!game_is_object_in_cooldown(state, obj, SHIP_MISSILE_COOLDOWN)) {
-				DLOG("shooting");
-				game_add_missile(state, obj);
-				obj->framecounter = state->framecounter;
-			} else {
-				DLOG("shooting cooldown");
+		case RECORD_LEAVE:
+			if (player_is_active(p)) {
+				game_remove_player(state, p);
 			}
 			break;
-		case NO_ACTION:
-			DLOG("no action");
+		case RECORD_PRESSES:
+			player_set_presses(p, ev->value);
 			break;
 		default:
-			ILOG("Unkown action %d", action);
 			break;
 	}
-
-	object_debug(obj, "post-action");
+	return false;
 }
 
-/* translates player key states into ship actions. */
-void game_handle_player(GameState *state, Player *p) {
-	if (p == NULL || !player_is_active(p)) {
-		return;
-	}
-	DLOG("handling player");
+/*
+ * Snapshots player input for this tick and records it, or when
+ * replaying, overwrites it with the recorded input first.
+ * Joins and leaves are recorded when they happen, so only
+ * presses are written here.
+ */
+void game_handle_recording(GameState *state) {
+	Recorder *rec = &state->recorder;
 
-	ShipAction action = NO_ACTION;
-	if (p->p_w || p->p_up || p->p_g_up || p->p_g_a) {
-		DLOG("player speeding up");
-		game_handle_ship_action(state, p->ship, SPEED_UP);
-	}
-	if (p->p_s || p->p_down || p->p_g_down || p->p_g_b) {
-		DLOG("player speeding down");
-		game_handle_ship_action(state, player_ship(p), SPEED_DOWN);
-	}
-	if (p->p_a || p->p_left || p->p_g_left) {
-		DLOG("player turning left");
-		game_handle_ship_action(state, player_ship(p), TURN_LEFT);
-	}
-	if (p->p_d || p->p_right || p->p_g_right) {
-		DLOG("player turning right");
-		game_handle_ship_action(state, player_ship(p), TURN_RIGHT);
-	}
-	if (p->p_space || p->p_g_x) {
-		DLOG("player shooting");
-		game_handle_ship_action(state, player_ship(p), SHOOT);
+	while (record_has_event(rec, state->ticks)) {
+		if (game_replay_event(state, &rec->next)) {
+			ILOG("stopping corrupt replay at tick %llu", (unsigned long long)state->ticks);
+			record_end_replay(rec, state->ticks);
+			break;
+		}
+		record_read_next(rec);
 	}
-}
 
-/* handles all players */
-void game_handle_players(GameState *state) {
-	for (uint32_t i = 0; i < MAX_PLAYERS; i++) {
-		game_handle_player(state, &state->players[i]);
+	game_snapshot_inputs(state);
+	if (record_is_recording(rec)) {
+		for (uint32_t i = 0; i < state->limits.maxPlayers; i++) {
+			if (player_is_active(&state->players[i])) {
+				record_presses(rec, state->ticks, i, state->inputs[i]);
+			}
+		}
 	}
 }
 
 /* handles local input as parsed by raylib. */
 void game_handle_local_keypress(GameState *state) {
-	ShipAction action = NO_ACTION;
-
 	Player *localPlayer = NULL;
 
+	if (state->headless) {
+		return;
+	}
+
 	//Adds a local player. Should maybe be done in add_player fn.
 	if (IsKeyDown(KEY_O) && !game_is_local_player_active(state)) {
 		ILOG("adding local player");
@@ -462,16 +736,19 @@ void game_handle_local_keypress(GameState *state) {
 
 	DLOG("handling local key player presses");
 
-	state->localPlayer->p_w = IsKeyDown(KEY_W);
-	state->localPlayer->p_up = IsKeyDown(KEY_UP);
-	state->localPlayer->p_s = IsKeyDown(KEY_S);
-	state->localPlayer->p_down = IsKeyDown(KEY_DOWN);
-	state->localPlayer->p_a = IsKeyDown(KEY_A);
-	state->localPlayer->p_left = IsKeyDown(KEY_LEFT);
-	state->localPlayer->p_d = IsKeyDown(KEY_D);
-	state->localPlayer->p_right = IsKeyDown(KEY_RIGHT);
-	state->localPlayer->p_space = IsKeyDown(KEY_SPACE);
-	state->localPlayer->p_q = IsKeyDown(KEY_Q);
+	//local player has no gamepad, so those presses are all cleared.
+	uint32_t bits = 0;
+	if (IsKeyDown(KEY_W)) { bits |= PRESS_W; }
+	if (IsKeyDown(KEY_UP)) { bits |= PRESS_UP; }
+	if (IsKeyDown(KEY_S)) { bits |= PRESS_S; }
+	if (IsKeyDown(KEY_DOWN)) { bits |= PRESS_DOWN; }
+	if (IsKeyDown(KEY_A)) { bits |= PRESS_A; }
+	if (IsKeyDown(KEY_LEFT)) { bits |= PRESS_LEFT; }
+	if (IsKeyDown(KEY_D)) { bits |= PRESS_D; }
+	if (IsKeyDown(KEY_RIGHT)) { bits |= PRESS_RIGHT; }
+	if (IsKeyDown(KEY_SPACE)) { bits |= PRESS_SPACE; }
+	if (IsKeyDown(KEY_Q)) { bits |= PRESS_Q; }
+	player_set_presses(localPlayer, bits);
 }
 
 /* increments destruction counters for objects, and deactivates
@@ -479,10 +756,12 @@ void game_handle_local_keypress(GameState *state) {
  */
 void game_handle_destructions(GameState *state) {
 	DLOG("handling destruction");
-	for (uint32_t i = 0; i < MAX_OBJS; i++) {
+	ObjectStore *store = &state->store;
+	//backwards, since deactivating removes from the live list.
+	for (uint32_t k = store_n_live(store); k-- > 0;) {
+		uint32_t i = store_live(store, k);
 		Object *obj = &state->objs[i];
-		if (object_is_active(obj) &&
-				object_is_destroyed(obj)) {
+		if (store_has_flags(store, i, OBJECT_DESTROYED)) {
 			//NB risk for segfault here if indexing is wrong
 			uint32_t destructThreshold = DESTRUCTION_THRESHOLDS[object_type(obj)];
 			if (object_increment_destroy(obj) > destructThreshold) {
@@ -492,10 +771,14 @@ void game_handle_destructions(GameState *state) {
 	}
 }
 
-/* increments frame counter */
+/* increments frame counter, and counts down welcome text */
 void game_handle_frame_end(GameState *state) {
 	//will overflow, but we don't care, loops back around.
 	state->framecounter++;
+	state->ticks++;
+	if (state->welcomeTextCooldown > 0) {
+		state->welcomeTextCooldown--;
+	}
 }
 
 /* resets game state if we're on 0 frame (first game run),
@@ -505,7 +788,7 @@ void game_handle_reset(GameState *state) {
 
 	bool allWantReset = game_get_n_players(state) > 0; //don't reset on 0 players
 
-	for (uint32_t i = 0; i < MAX_PLAYERS; i++) {
+	for (uint32_t i = 0; i < state->limits.maxPlayers; i++) {
 		Player *p = &state->players[i];
 		if (player_is_active(p)) {
 			bool thisReset = player_is_reset_requested(p);
@@ -516,15 +799,15 @@ void game_handle_reset(GameState *state) {
 
 	if (state->framecounter == 0 || (allWantReset && state->framecounter > RESET_COOLDOWN)) {
 		ILOG("resetting game");
-		for (uint32_t i = 0; i < MAX_OBJS; i++) {
-			object_deactivate(&state->objs[i]);
+		while (store_n_live(&state->store) > 0) {
+			object_deactivate(&state->objs[store_live(&state->store, 0)]);
 		}
 
 		for (uint32_t i = 0; i < N_START_ASTEROIDS; i++) {
 			game_add_object(state, ASTEROID, WHITE);
 		}
 
-		for (uint32_t i = 0; i < MAX_PLAYERS; i++) {
+		for (uint32_t i = 0; i < state->limits.maxPlayers; i++) {
 			Player *p = &state->players[i];
 			player_reset(p);
 		}
@@ -541,19 +824,21 @@ void game_handle_reset(GameState *state) {
  */
 void game_handle_asteroid_spawn(GameState *state) {
 	float nAsteroidsMidpoint, baseSpawnP, asteroidSpawnP;
-	int nAsteroids = game_get_n_objects(state, ASTEROID);
+	uint32_t nAsteroids = game_get_n_objects(state, ASTEROID);
 
-	if (nAsteroids >= MAX_ASTEROIDS) {
+	uint32_t maxAsteroids = state->limits.maxAsteroids;
+
+	if (nAsteroids >= maxAsteroids) {
 		return;
 	}
 
-	nAsteroidsMidpoint = (MAX_ASTEROIDS - N_START_ASTEROIDS) / 2;
-	baseSpawnP = EXPECTED_ASTEROIDS_PER_SEC / FPS;
+	nAsteroidsMidpoint = (maxAsteroids - N_START_ASTEROIDS) / 2;
+	baseSpawnP = EXPECTED_ASTEROIDS_PER_SEC * maxAsteroids / DEFAULT_MAX_ASTEROIDS / FPS;
 	asteroidSpawnP = baseSpawnP * (
 		1 + ASTEROID_SPAWN_DRIVER *
 			(nAsteroidsMidpoint - nAsteroids) / nAsteroidsMidpoint);
 
-	if (random_prob(asteroidSpawnP)) {
+	if (random_prob(&state->rng, asteroidSpawnP)) {
 		DLOG("spawn asteroid triggered");
 		game_add_object(state, ASTEROID, WHITE);
 	}
@@ -561,11 +846,33 @@ void game_handle_asteroid_spawn(GameState *state) {
 
 /** DRAWING **/
 
+/* re-renders welcome and score texts whose contents changed,
+ * see text.c. Must be done before the frame is begun. */
+void game_update_texts(GameState *state) {
+	if (state->welcomeTextCooldown > 0 && text_is_stale(&state->welcomeText, 0, WHITE)) {
+		text_render(&state->welcomeText, WELCOME_TEXT, GAME_FONT_SIZE, 0, WHITE);
+	}
+	char text[32];
+	for (uint32_t i = 0; i < state->limits.maxPlayers; i++) {
+		Player *p = &state->players[i];
+		if (!player_is_active(p)) {
+			continue;
+		}
+		//score and reset flag are all the text is made from, besides color.
+		bool resetRequested = player_is_reset_requested(p);
+		uint64_t key = (uint64_t)player_score(p) | (uint64_t)resetRequested << 32;
+		if (text_is_stale(&state->scoreTexts[i], key, player_color(p))) {
+			const char *fmtString = resetRequested ? RESET_TEXT : "%d";
+			snprintf(&text[0], 32, fmtString, player_score(p));
+			text_render(&state->scoreTexts[i], text, GAME_FONT_SIZE, key, player_color(p));
+		}
+	}
+}
+
 /* draws welcome if cooldown in effect */
 void game_draw_welcome(GameState *state) {
 	if (state->welcomeTextCooldown > 0) {
-		DrawText(WELCOME_TEXT, 0, 0, GAME_FONT_SIZE, WHITE);
-		state->welcomeTextCooldown--;
+		text_draw(&state->welcomeText, 0, 0);
 	}
 }
 
@@ -576,46 +883,205 @@ void game_draw_scoreboard(GameState *state) {
 		return;
 	}
 	float chunk = SCREEN_W / nPlayers;
-	char text[32];
-	for (uint32_t i = 0; i < MAX_PLAYERS; i++) {
+	for (uint32_t i = 0; i < state->limits.maxPlayers; i++) {
 		Player *p = &state->players[i];
 		if (player_is_active(p)) {
 			float x = i * chunk + chunk/2;
-			const char *fmtString = player_is_reset_requested(p) ? RESET_TEXT : "%d";
-			snprintf(&text[0], 32, fmtString, player_score(p));
-			DrawText(text, x, SCOREBOARD_Y_OFFSET, GAME_FONT_SIZE, player_color(p));
+			text_draw(&state->scoreTexts[i], x, SCOREBOARD_Y_OFFSET);
 		}
 	}
 }
 
-/* draws all active objects. */
-void game_draw_objects(GameState *state) {
+/* returns the player whose view is drawn: the local player,
+ * otherwise the first active one. NULL if there are no players. */
+Player* game_get_viewer(GameState *state) {
+	if (game_is_local_player_active(state)) {
+		return game_get_local_player(state);
+	}
+	for (uint32_t i = 0; i < state->limits.maxPlayers; i++) {
+		if (player_is_active(&state->players[i])) {
+			return &state->players[i];
+		}
+	}
+	return NULL;
+}
 
-	for (uint32_t i = 0; i < MAX_OBJS; i++) {
-		Object *obj = &state->objs[i];
-		if (object_is_active(obj)) {
-			object_draw(obj);
+/* points every active player's camera at their ship, where it's
+ * drawn alpha of the way between ticks. */
+void game_update_cameras(GameState *state, float alpha) {
+	for (uint32_t i = 0; i < state->limits.maxPlayers; i++) {
+		Player *p = &state->players[i];
+		if (player_is_active(p)) {
+			Object *ship = player_ship(p);
+			Vector2 target = vector_add(object_midpoint(ship), object_draw_offset(ship, alpha));
+			camera_follow(&p->camera, target, state->limits.worldW, state->limits.worldH);
 		}
 	}
 }
 
-/* draws game */
-void game_draw(GameState *state) {
-	BeginDrawing();
+/* returns camera to draw with, the viewer's, or the world's
+ * top left if there is no viewer. */
+Camera2D game_get_camera(GameState *state) {
+	Camera2D cam = { 0 };
+	Player *viewer = game_get_viewer(state);
+	if (viewer != NULL) {
+		return viewer->camera;
+	}
+	camera_follow(&cam, cam.target, state->limits.worldW, state->limits.worldH);
+	return cam;
+}
+
+/*
+ * draws active objects in cam's view, alpha of the way between ticks.
+ * Objects near the view are found with the grid, so the cost depends
+ * on how many objects are in view, not in the world.
+ * The grid is rebuilt once per tick for this, then invalidated, so
+ * collision checks outside of game_handle_objects still scan.
+ * Objects are batched by type if the renderer is, see render.c.
+ */
+void game_draw_objects(GameState *state, Camera2D *cam, float alpha) {
+	uint16_t *candidates = state->candidates;
+	Renderer *renderer = &state->renderer;
+	uint32_t drawn = 0;
+
+	if (state->cullStale) {
+		grid_build(&state->grid, &state->store, state->objs);
+		grid_invalidate(&state->grid);
+		state->cullStale = false;
+	}
+
+	Rectangle view = camera_view(cam, 0);
+	uint32_t n = grid_query_rect(&state->grid, camera_view(cam, CULL_MARGIN), candidates);
+	render_begin(renderer);
+	for (uint32_t k = 0; k < n; k++) {
+		Object *obj = &state->objs[candidates[k]];
+		Rectangle bounds = object_bounds(obj);
+		Vector2 offset = object_draw_offset(obj, alpha);
+		bounds.x += offset.x;
+		bounds.y += offset.y;
+		if (!object_is_active(obj) || !camera_is_visible(view, bounds)) {
+			continue;
+		}
+		if (renderer->batched) {
+			render_add(renderer, obj, alpha);
+		} else {
+			object_draw(obj, alpha);
+		}
+		drawn++;
+	}
+	render_end(renderer);
+	profile_drawn(&state->profiler, drawn, store_n_live(&state->store),
+			renderer->batched ? renderer->nCalls : drawn, renderer->batched);
+}
+
+/* draws game. alpha is how far we are between the last tick and
+ * the next, 1.0 draws the state as of the last tick.
+ * Game is drawn into the frame texture, which is then copied to
+ * the screen. Parsec is sent the texture as is.
+ * Does nothing if headless. */
+void game_draw(GameState *state, float alpha) {
+	if (state->headless) {
+		return;
+	}
+	game_update_texts(state);
+	BeginTextureMode(state->frame);
 	ClearBackground(BLACK);
 
 	game_draw_welcome(state);
 	game_draw_scoreboard(state);
-	game_draw_objects(state);
 
+	//objects are drawn in world space, through the viewer's camera.
+	game_update_cameras(state, alpha);
+	Camera2D cam = game_get_camera(state);
+	BeginMode2D(cam);
+	if (state->limits.worldW > SCREEN_W || state->limits.worldH > SCREEN_H) {
+		DrawRectangleLines(0, 0, state->limits.worldW, state->limits.worldH, WORLD_EDGE_COLOR);
+	}
+	game_draw_objects(state, &cam, alpha);
+	EndMode2D();
+
+	EndTextureMode();
+
+	BeginDrawing();
+	//render textures are stored upside down, so flip with negative height.
+	Rectangle source = {0, 0, state->frame.texture.width, -state->frame.texture.height};
+	Vector2 origin = {0, 0};
+	DrawTextureRec(state->frame.texture, source, origin, WHITE);
+	//drawn on screen only, guests don't need to see it.
+	if (state->profiler.overlay) {
+		profile_draw(&state->profiler, 10, SCOREBOARD_Y_OFFSET + 2 * GAME_FONT_SIZE);
+	}
 	EndDrawing();
 }
 
+/** SIMULATION **/
+
+/* runs one frame of game logic, after input has been read into players.
+ * Doesn't draw, so can be run headless. */
+void game_tick(GameState *state) {
+	Profiler *prof = &state->profiler;
+	profile_begin(prof, PROFILE_TICK);
+
+	DLOG("recording");
+	profile_begin(prof, PROFILE_RECORD);
+	game_handle_recording(state);
+	profile_end(prof, PROFILE_RECORD);
+
+	DLOG("handling reset");
+	profile_begin(prof, PROFILE_RESET);
+	game_handle_reset(state);
+	profile_end(prof, PROFILE_RESET);
+
+	DLOG("handling objects");
+	profile_begin(prof, PROFILE_OBJECTS);
+	game_handle_objects(state);
+	profile_end(prof, PROFILE_OBJECTS);
+
+	DLOG("destructions");
+	profile_begin(prof, PROFILE_DESTRUCTIONS);
+	game_handle_destructions(state);
+	profile_end(prof, PROFILE_DESTRUCTIONS);
+
+	DLOG("spawning asteroids");
+	profile_begin(prof, PROFILE_SPAWN);
+	game_handle_asteroid_spawn(state);
+	profile_end(prof, PROFILE_SPAWN);
+
+	DLOG("handling players");
+	profile_begin(prof, PROFILE_PLAYERS);
+	game_handle_players(state);
+	profile_end(prof, PROFILE_PLAYERS);
+
+	DLOG("frame end");
+	profile_begin(prof, PROFILE_FRAME_END);
+	game_handle_frame_end(state);
+	profile_end(prof, PROFILE_FRAME_END);
+
+	profile_collisions(prof, state->store.nPairTests, state->store.nNarrowTests);
+	profile_population(prof, game_get_stats(state));
+	store_reset_tests(&state->store);
+	state->cullStale = true;
+
+	profile_end(prof, PROFILE_TICK);
+}
+
 /* DEINIT */
 
-/* deinitalizes game */
+/* deinitalizes game, writing profile if asked to */
 void game_deinit(GameState *state) {
-	CloseWindow();        // Close window and OpenGL context
+	if (state->profilePath != NULL) {
+		profile_dump(&state->profiler, state->profilePath);
+	}
+	record_close(&state->recorder, state->ticks);
+	if (!state->headless) {
+		text_unload(&state->welcomeText);
+		for (uint32_t i = 0; i < state->limits.maxPlayers; i++) {
+			text_unload(&state->scoreTexts[i]);
+		}
+		UnloadRenderTexture(state->frame);
+		CloseWindow();        // Close window and OpenGL context
+	}
+	arena_free(&state->arena);
 }
 
 #endif /* GAME_C */
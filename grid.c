@@ -0,0 +1,231 @@
+/*
+ * Uniform grid broad phase for collision detection.
+ * Objects are bucketed by the cells their bounds touch,
+ * so collision checks only run against objects nearby.
+ * Objects are referred to by their index in the object array.
+ */
+#ifndef GRID_C
+#define GRID_C
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "types.h"
+#include "raylib.h"
+
+#include "arena.c"
+#include "object.c"
+
+/* carves a grid covering limits' world, for limits->maxObjs objects, from arena. */
+void grid_init(Grid *grid, Arena *arena, Limits *limits) {
+	grid->cols = (limits->worldW + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE;
+	grid->rows = (limits->worldH + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE;
+	grid->capacity = limits->maxObjs;
+	grid->cells = arena_alloc(arena, (size_t)grid->cols * grid->rows * sizeof(GridCell));
+	grid->spans = arena_alloc(arena, grid->capacity * sizeof(GridSpan));
+	grid->oversize = arena_alloc(arena, grid->capacity * sizeof(uint16_t));
+	grid->stamps = arena_alloc(arena, grid->capacity * sizeof(uint32_t));
+}
+
+/* converts a coordinate to a cell index, clamped to the grid. */
+uint16_t grid_cell_coord(float v, uint32_t nCells) {
+	if (!(v > 0)) { //also catches NaN
+		return 0;
+	}
+	uint32_t c = (uint32_t)(v / GRID_CELL_SIZE);
+	return c >= nCells ? nCells - 1 : c;
+}
+
+/* returns the cell range covered by rec. */
+GridSpan grid_span_rect(Grid *grid, Rectangle rec) {
+	GridSpan span = { 0 };
+	span.x0 = grid_cell_coord(rec.x, grid->cols);
+	span.y0 = grid_cell_coord(rec.y, grid->rows);
+	span.x1 = grid_cell_coord(rec.x + rec.width, grid->cols);
+	span.y1 = grid_cell_coord(rec.y + rec.height, grid->rows);
+	return span;
+}
+
+/* returns the cell range covered by obj's bounds. */
+GridSpan grid_span(Grid *grid, Object *obj) {
+	return grid_span_rect(grid, object_bounds(obj));
+}
+
+/* true iff span covers too many cells to insert one by one */
+bool grid_is_span_oversize(GridSpan *span) {
+	return (uint32_t)((span->x1 - span->x0 + 1) * (span->y1 - span->y0 + 1)) > GRID_MAX_SPAN;
+}
+
+/* gets the cell at (x, y) */
+GridCell* grid_cell(Grid *grid, uint32_t x, uint32_t y) {
+	return &grid->cells[y * grid->cols + x];
+}
+
+/* removes object i from the grid, if it's in it. */
+void grid_remove(Grid *grid, uint32_t i) {
+	GridSpan *span = &grid->spans[i];
+	if (!span->inserted) {
+		return;
+	}
+
+	if (span->oversize) {
+		for (uint32_t k = 0; k < grid->nOversize; k++) {
+			if (grid->oversize[k] == i) {
+				grid->oversize[k] = grid->oversize[--grid->nOversize];
+				break;
+			}
+		}
+	} else {
+		for (uint32_t y = span->y0; y <= span->y1; y++) {
+			for (uint32_t x = span->x0; x <= span->x1; x++) {
+				GridCell *cell = grid_cell(grid, x, y);
+				for (uint32_t k = 0; k < cell->n; k++) {
+					if (cell->objs[k] == i) {
+						cell->objs[k] = cell->objs[--cell->n];
+						break;
+					}
+				}
+			}
+		}
+	}
+	span->inserted = false;
+}
+
+/* inserts object i into the cells its bounds touch.
+ * Falls back to the oversize list if the object covers
+ * too many cells, or one of its cells is full. */
+void grid_insert(Grid *grid, Object *objs, uint32_t i) {
+	GridSpan span = grid_span(grid, &objs[i]);
+	span.inserted = true;
+	span.oversize = grid_is_span_oversize(&span);
+
+	for (uint32_t y = span.y0; y <= span.y1 && !span.oversize; y++) {
+		for (uint32_t x = span.x0; x <= span.x1; x++) {
+			if (grid_cell(grid, x, y)->n >= GRID_CELL_CAPACITY) {
+				span.oversize = true;
+				break;
+			}
+		}
+	}
+
+	if (span.oversize) {
+		grid->oversize[grid->nOversize++] = i;
+	} else {
+		for (uint32_t y = span.y0; y <= span.y1; y++) {
+			for (uint32_t x = span.x0; x <= span.x1; x++) {
+				GridCell *cell = grid_cell(grid, x, y);
+				cell->objs[cell->n++] = i;
+			}
+		}
+	}
+	grid->spans[i] = span;
+}
+
+/* re-buckets object i after it moved, was placed or deactivated. */
+void grid_update(Grid *grid, Object *objs, uint32_t i) {
+	grid_remove(grid, i);
+	if (object_is_active(&objs[i])) {
+		grid_insert(grid, objs, i);
+	}
+}
+
+/* clears the grid and inserts all active objects.
+ * Only empties the cells objects were left in, since big
+ * worlds have far more cells than objects. */
+void grid_build(Grid *grid, ObjectStore *store, Object *objs) {
+	for (uint32_t i = 0; i < grid->capacity; i++) {
+		grid_remove(grid, i);
+	}
+
+	for (uint32_t k = 0; k < store_n_live(store); k++) {
+		grid_insert(grid, objs, store_live(store, k));
+	}
+	grid->valid = true;
+}
+
+/* marks grid as stale, so it isn't queried until next build. */
+void grid_invalidate(Grid *grid) {
+	grid->valid = false;
+}
+
+/* true iff object i hasn't been seen in this query yet. marks it seen. */
+bool grid_visit(Grid *grid, uint32_t i) {
+	if (grid->stamps[i] == grid->stamp) {
+		return false;
+	}
+	grid->stamps[i] = grid->stamp;
+	return true;
+}
+
+/* starts a new query, and writes oversize objects to out.
+ * returns number written. */
+uint32_t grid_query_begin(Grid *grid, uint16_t *out) {
+	uint32_t n = 0;
+
+	//new stamp per query, reset stamps when it wraps around.
+	if (++grid->stamp == 0) {
+		memset(grid->stamps, 0, grid->capacity * sizeof(grid->stamps[0]));
+		grid->stamp = 1;
+	}
+
+	for (uint32_t k = 0; k < grid->nOversize; k++) {
+		if (grid_visit(grid, grid->oversize[k])) {
+			out[n++] = grid->oversize[k];
+		}
+	}
+	return n;
+}
+
+/* writes objects in span's cells to out, from n on, skipping
+ * ones already found. returns new count. */
+uint32_t grid_query_cells(Grid *grid, GridSpan span, uint16_t *out, uint32_t n) {
+	for (uint32_t y = span.y0; y <= span.y1; y++) {
+		for (uint32_t x = span.x0; x <= span.x1; x++) {
+			GridCell *cell = grid_cell(grid, x, y);
+			for (uint32_t k = 0; k < cell->n; k++) {
+				if (grid_visit(grid, cell->objs[k])) {
+					out[n++] = cell->objs[k];
+				}
+			}
+		}
+	}
+	return n;
+}
+
+/*
+ * Finds all objects that share a cell with obj, or are oversize.
+ * Indices are written to out, which must fit an entry per object.
+ * Returns number of candidates found. Each candidate appears once,
+ * and obj itself may be among them.
+ */
+uint32_t grid_query(Grid *grid, Object *obj, uint16_t *out) {
+	GridSpan span = grid_span(grid, obj);
+	uint32_t n = grid_query_begin(grid, out);
+
+	if (grid_is_span_oversize(&span)) {
+		//query covers most of the world, cheaper to check everything.
+		for (uint32_t i = 0; i < grid->capacity; i++) {
+			if (grid->spans[i].inserted && grid_visit(grid, i)) {
+				out[n++] = i;
+			}
+		}
+		return n;
+	}
+	return grid_query_cells(grid, span, out, n);
+}
+
+/*
+ * Finds all objects in cells touching rec, or oversize, as of
+ * the last build. Unlike grid_query, always walks the cells, since
+ * it's used for views, which cover many cells but few objects.
+ * Works on an invalidated grid, but objects (de)activated since the
+ * build are missed or stale. Same output as grid_query.
+ */
+uint32_t grid_query_rect(Grid *grid, Rectangle rec, uint16_t *out) {
+	uint32_t n = grid_query_begin(grid, out);
+	return grid_query_cells(grid, grid_span_rect(grid, rec), out, n);
+}
+
+#endif /* GRID_C */
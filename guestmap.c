@@ -0,0 +1,75 @@
+/*
+ * Hash map from parsec guest ids to player slots, so input
+ * messages find their player without scanning all players.
+ * Open addressing with linear probing. Buckets are at least
+ * twice the players, so probes stay short, and removal shifts
+ * later entries back instead of leaving tombstones.
+ */
+#ifndef GUESTMAP_C
+#define GUESTMAP_C
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "types.h"
+#include "arena.c"
+
+/* carves buckets for limits->maxPlayers guests from arena */
+void guestmap_init(GuestMap *map, Arena *arena, Limits *limits) {
+	uint32_t n = 1;
+	while (n < 2 * limits->maxPlayers) {
+		n *= 2;
+	}
+	map->mask = n - 1;
+	map->ids = arena_alloc(arena, n * sizeof(uint32_t));
+	map->slots = arena_alloc(arena, n * sizeof(uint16_t));
+}
+
+/* bucket id hashes to, before probing */
+uint32_t guestmap_hash(GuestMap *map, uint32_t id) {
+	return (id * 2654435761u) & map->mask;
+}
+
+/* returns bucket holding id, or the empty bucket it would go in */
+uint32_t guestmap_probe(GuestMap *map, uint32_t id) {
+	uint32_t b = guestmap_hash(map, id);
+	while (map->slots[b] != 0 && map->ids[b] != id) {
+		b = (b + 1) & map->mask;
+	}
+	return b;
+}
+
+/* returns player slot of guest id, or -1 if it has none */
+int32_t guestmap_find(GuestMap *map, uint32_t id) {
+	uint32_t b = guestmap_probe(map, id);
+	return map->slots[b] != 0 ? map->slots[b] - 1 : -1;
+}
+
+/* maps guest id to player slot, replacing any slot it had */
+void guestmap_insert(GuestMap *map, uint32_t id, uint32_t slot) {
+	uint32_t b = guestmap_probe(map, id);
+	map->ids[b] = id;
+	map->slots[b] = slot + 1;
+}
+
+/* unmaps guest id if it maps to slot. Entries probed past
+ * its bucket are moved back, so lookups still reach them. */
+void guestmap_remove(GuestMap *map, uint32_t id, uint32_t slot) {
+	uint32_t b = guestmap_probe(map, id);
+	if (map->slots[b] != slot + 1) {
+		return;
+	}
+	map->slots[b] = 0;
+	for (uint32_t next = (b + 1) & map->mask; map->slots[next] != 0; next = (next + 1) & map->mask) {
+		uint32_t home = guestmap_hash(map, map->ids[next]);
+		//entry stays unless the hole lies between its home bucket and it, cyclically.
+		if (((next - home) & map->mask) >= ((next - b) & map->mask)) {
+			map->ids[b] = map->ids[next];
+			map->slots[b] = map->slots[next];
+			map->slots[next] = 0;
+			b = next;
+		}
+	}
+}
+
+#endif /* GUESTMAP_C */
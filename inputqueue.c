@@ -0,0 +1,42 @@
+/*
+ * Lock-free queue handing input from the input thread to the tick.
+ * One thread pushes, the other pops. Each only writes its own end,
+ * publishing it with release order after touching the events, and
+ * reads the other end with acquire order before touching them.
+ */
+#ifndef INPUTQUEUE_C
+#define INPUTQUEUE_C
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "types.h"
+
+/* copies ev to the back of q.
+ * returns true iff there was room, like inputqueue_pop. */
+bool inputqueue_push(InputQueue *q, InputEvent *ev) {
+	uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+	uint32_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+	if (tail - head == INPUT_QUEUE_SIZE) {
+		return false;
+	}
+	q->events[tail % INPUT_QUEUE_SIZE] = *ev;
+	atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+	return true;
+}
+
+/* moves front of q into ev.
+ * returns true iff there was an event, so it can drive a loop. */
+bool inputqueue_pop(InputQueue *q, InputEvent *ev) {
+	uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+	uint32_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+	if (head == tail) {
+		return false;
+	}
+	*ev = q->events[head % INPUT_QUEUE_SIZE];
+	atomic_store_explicit(&q->head, head + 1, memory_order_release);
+	return true;
+}
+
+#endif /* INPUTQUEUE_C */
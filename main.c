@@ -15,42 +15,86 @@
 
 /* Game functions stored in main to avoid circilar import hassles. */
 
-/* Handles one frame of game logic. */
+/* returns monotonic time in seconds */
+double main_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Reads parsec and local input into players.
+ * Parsec is polled on the input thread, this applies what it queued. */
+void input(GameState *state) {
+	Profiler *prof = &state->profiler;
+
+	DLOG("parsec inputs");
+	profile_begin(prof, PROFILE_PARSEC_INPUT);
+	if (parsecify_drain_input(&state->parsecInput, state)) {
+		game_trigger_welcome(state);
+	}
+	profile_end(prof, PROFILE_PARSEC_INPUT);
+
+	DLOG("local inputs");
+	profile_begin(prof, PROFILE_LOCAL_INPUT);
+	game_handle_local_keypress(state);
+	profile_end(prof, PROFILE_LOCAL_INPUT);
+}
+
+/* Handles one frame: runs a game tick for every 1/FPS seconds
+ * that passed since the last frame, then draws.
+ * That way game speed doesn't depend on how fast we can render.
+ * Headless games just tick, as fast as they can.
+ */
 void loop(GameState *state) {
-	DLOG("handling reset");
-	game_handle_reset(state);
+	const double tickTime = 1.0 / FPS;
+	uint32_t nTicks = 0;
+	Profiler *prof = &state->profiler;
 
-	DLOG("drawing");
-	game_draw(state);
+	if (state->headless) {
+		game_tick(state);
+		return;
+	}
 
-	DLOG("submitting frame");
-	parsecify_submit_frame(state->parsec);
+	profile_begin(prof, PROFILE_FRAME);
 
-	DLOG("handling objectsl");
-	game_handle_objects(state);
+	double now = main_now();
+	if (state->lastFrameTime > 0) {
+		state->tickAccumulator += now - state->lastFrameTime;
+	}
+	state->lastFrameTime = now;
 
-	DLOG("destructions");
-	game_handle_destructions(state);
+	while (state->tickAccumulator >= tickTime && nTicks < MAX_TICKS_PER_FRAME) {
+		input(state);
 
-	DLOG("spawning asteroids");
-	game_handle_asteroid_spawn(state);
+		DLOG("simulating");
+		game_tick(state);
 
-	DLOG("parsec events");
-	if(parsecify_check_events(state->parsec, state)) {
-		game_trigger_welcome(state);
+		state->tickAccumulator -= tickTime;
+		nTicks++;
+	}
+	if (state->tickAccumulator >= tickTime) {
+		DLOG("dropping %f seconds of game time", state->tickAccumulator);
+		state->tickAccumulator = fmod(state->tickAccumulator, tickTime);
 	}
 
-	DLOG("parsec inputs");
-	parsecify_check_input(state->parsec, state);
+	if (IsKeyPressed(PROFILE_OVERLAY_KEY)) {
+		prof->overlay = !prof->overlay;
+	}
+	if (IsKeyPressed(RENDER_BATCH_KEY)) {
+		state->renderer.batched = !state->renderer.batched;
+	}
 
-	DLOG("local inputs");
-	game_handle_local_keypress(state);
+	DLOG("drawing");
+	profile_begin(prof, PROFILE_DRAW);
+	game_draw(state, state->tickAccumulator / tickTime);
+	profile_end(prof, PROFILE_DRAW);
 
-	DLOG("handling players");
-	game_handle_players(state);
+	DLOG("submitting frame");
+	profile_begin(prof, PROFILE_SUBMIT_FRAME);
+	parsecify_submit_frame(state->parsec, state->frame.texture);
+	profile_end(prof, PROFILE_SUBMIT_FRAME);
 
-	DLOG("frame end");
-	game_handle_frame_end(state);
+	profile_end(prof, PROFILE_FRAME);
 }
 
 /* main loop */
@@ -60,32 +104,50 @@ int main(int argc, char *argv[])
     //--------------------------------------------------------------------------------------
 		char *session;
 		GameState state = { 0 };
+		int status = 0;
 
-		if (argc < 2) {
-			printf("Usage: ./ [session-id]\n");
+		if (argc < 2 || !game_parse_options(&state, argc - 2, argv + 2)) {
+			printf("Usage: ./ [session-id] [%s ticks] [%s file] [%s number] [%s file] [%s file] [%s]"
+						" [%s number] [%s number] [%s number] [%s WxH]\n",
+						HEADLESS_OPTION, PROFILE_OPTION, SEED_OPTION, RECORD_OPTION, REPLAY_OPTION, SWEPT_OPTION,
+						OBJECTS_OPTION, PLAYERS_OPTION, ASTEROIDS_OPTION, WORLD_OPTION);
 			return 1;
 		}
 
 		session = argv[1];
-		game_init(&state);
+		if (game_init(&state)) {
+			return 1;
+		}
 
-		if (strcmp(session, DISABLE_PARSEC) == 0) {
+		if (strcmp(session, DISABLE_PARSEC) == 0 || state.headless) {
 			ILOG("skipping parsec init");
 		} else {
 			if(parsecify_init(&state.parsec, session)) {
 				return 1;
 			}
+			//parsec is up by now, so fail through the usual cleanup.
+			if (parsecify_start_input(&state.parsecInput, state.parsec)) {
+				status = 1;
+			}
 		}
     //--------------------------------------------------------------------------------------
 
     // Main game loop
-    while (!WindowShouldClose())    // Detect window close button or ESC key
+		double start = main_now();
+    while (status == 0 && !game_should_close(&state))    // Detect window close button or ESC key
     {
 			loop(&state);
     }
 
-		game_deinit(&state);
+		if (state.headless) {
+			double elapsed = main_now() - start;
+			ILOG("simulated %llu ticks in %.2fs (%.0f ticks/s)",
+					(unsigned long long)state.ticks, elapsed, state.ticks / elapsed);
+		}
+
+		//parsec first, it kicks players, which game_deinit frees.
 		parsecify_deinit(state.parsec, &state);
+		game_deinit(&state);
 
-    return 0;
+    return status;
 }
@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "types.h"
 #include "raylib.h"
@@ -11,6 +12,90 @@
 
 #include "random.c"
 #include "vector.c"
+#include "store.c"
+
+/** STORAGE **/
+//Position, velocity, type and flags live in the object store,
+//these are the only functions that touch them directly.
+
+/* binds obj to slot id in store. Must be done once before use. */
+void object_bind(Object *obj, ObjectStore *store, uint32_t id) {
+	obj->store = store;
+	obj->id = id;
+}
+
+/* gets object x coord */
+float object_x(Object *obj) {
+	return obj->store->x[obj->id];
+}
+
+/* gets object y coord */
+float object_y(Object *obj) {
+	return obj->store->y[obj->id];
+}
+
+/* gets object type */
+ObjectType object_type(Object *obj) {
+	return obj->store->type[obj->id];
+}
+
+/* true iff objects is active */
+bool object_is_active(Object *obj) {
+	return store_has_flags(obj->store, obj->id, OBJECT_ACTIVE);
+}
+
+/* true iff object is destroyed */
+bool object_is_destroyed(Object *obj) {
+	return store_has_flags(obj->store, obj->id, OBJECT_DESTROYED);
+}
+
+/* sets or clears flag on object */
+void object_set_flag(Object *obj, uint8_t flag, bool on) {
+	if (on) {
+		obj->store->flags[obj->id] |= flag;
+	} else {
+		obj->store->flags[obj->id] &= ~flag;
+	}
+}
+
+/* sets active state, and keeps the store's live list in sync */
+void object_set_active(Object *obj, bool active) {
+	if (active == object_is_active(obj)) {
+		return;
+	}
+	object_set_flag(obj, OBJECT_ACTIVE, active);
+	if (active) {
+		store_link(obj->store, obj->id);
+	} else {
+		store_unlink(obj->store, obj->id);
+	}
+}
+
+/* marks cached points and bounds as stale, after a move or turn */
+void object_invalidate(Object *obj) {
+	obj->cached = false;
+}
+
+/* sets destruction counter, and flag that mirrors it */
+void object_set_destroyed(Object *obj, int destroyed) {
+	obj->destroyed = destroyed;
+	store_set_destroyed(obj->store, obj->id, destroyed > 0);
+}
+
+/* recalculates velocity from direction and speed */
+void object_update_velocity(Object *obj) {
+	obj->store->vx[obj->id] = obj->direction.x * obj->speed;
+	obj->store->vy[obj->id] = obj->direction.y * obj->speed;
+	object_invalidate(obj); //missile bounds include their previous position
+}
+
+/* sets previous position to current position, so drawing
+ * doesn't interpolate across a jump (spawns, wraparound). */
+void object_settle(Object *obj) {
+	obj->store->px[obj->id] = object_x(obj);
+	obj->store->py[obj->id] = object_y(obj);
+	object_invalidate(obj); //swept bounds include previous position
+}
 
 /** DEBUGGING **/
 /*
@@ -18,11 +103,11 @@
  * used for debugging
  */
 char* object_type_string(Object *obj) {
-	if (obj->type == ASTEROID) {
+	if (object_type(obj) == ASTEROID) {
 		return "ASTEROID";
-	} else if(obj->type == SHIP) {
+	} else if(object_type(obj) == SHIP) {
 		return "SHIP";
-	} else if (obj->type == MISSILE) {
+	} else if (object_type(obj) == MISSILE) {
 		return "MISSILE";
 	}
 	return "UNKNOWN";
@@ -33,25 +118,36 @@ void object_debug(Object *obj, char *msg) {
 	DLOG("[%s]:%s (%f, %f)->(%f, %f)o(%f)x[%i]@%llu",
 			object_type_string(obj),
 			msg,
-			obj->x, obj->y,
+			object_x(obj), object_y(obj),
 			obj->direction.x, obj->direction.y,
 			obj->angle,
 			obj->destroyed,
-			obj->framecounter);
+			(unsigned long long)obj->framecounter);
 }
 
 /* prints object using info logger */
 void object_info(Object *obj) {
-	ILOG("[%s] (%f, %f)->(%f, %f)@(%f)", object_type_string(obj), obj->x, obj->y, obj->direction.x, obj->direction.y, obj->angle);
+	ILOG("[%s] (%f, %f)->(%f, %f)@(%f)", object_type_string(obj), object_x(obj), object_y(obj), obj->direction.x, obj->direction.y, obj->angle);
 }
 
 /** Initialization **/
 
-/* sets an object to 0 */
+/* sets an object to 0, keeping it bound to its store slot */
 void object_clear(Object *obj) {
 	Object empty = { 0 }; //tip from @cdd, sets whole struct to 0 values.
 	if (obj) {
+		object_set_active(obj, false);
+		empty.store = obj->store;
+		empty.id = obj->id;
 		*obj = empty;
+		obj->store->x[obj->id] = 0;
+		obj->store->y[obj->id] = 0;
+		obj->store->vx[obj->id] = 0;
+		obj->store->vy[obj->id] = 0;
+		obj->store->px[obj->id] = 0;
+		obj->store->py[obj->id] = 0;
+		obj->store->type[obj->id] = NONE;
+		obj->store->flags[obj->id] = 0;
 	}
 }
 
@@ -65,17 +161,26 @@ void object_init(Object *obj,
 			float angle,
 			Color col) {
 
+	if (!object_is_active(obj)) {
+		obj->owner = OBJECT_NO_OWNER; //new object, respawns keep their owner
+	}
 	obj->w = size.x;
 	obj->h = size.y;
 	obj->angle = angle;
 	obj->speed = speed;
-	obj->destroyed = 0;
-	obj->type = type;
-	obj->active = true;
+	object_set_destroyed(obj, 0);
+	if (object_type(obj) != type) {
+		object_set_active(obj, false); //so store counts it as the new type
+	}
+	obj->store->type[obj->id] = type;
+	object_set_active(obj, true);
 	obj->direction.x = direction.x;
 	obj->direction.y = direction.y;
-	obj->x = pos.x;
-	obj->y = pos.y;
+	object_update_velocity(obj);
+	obj->store->x[obj->id] = pos.x;
+	obj->store->y[obj->id] = pos.y;
+	object_invalidate(obj);
+	object_settle(obj);
 	obj->framecounter = 0;
 	obj->col = col;
 	object_debug(obj, "creating");
@@ -87,26 +192,29 @@ void object_init(Object *obj,
  * that it doesn't collide with existing objects.
  * Returns NULL if object is null
  */
-Object* object_activate(Object *obj, uint32_t type, Color col) {
+Object* object_activate(Object *obj, Random *rng, uint32_t type, Color col) {
 
 	uint32_t speed = 0;
 	float angle = 0;
-	Vector2 size, pos, direction;
-	pos = vector_random_position();
-	direction = vector_random_direction();
+	Vector2 size = { 0 }, pos, direction;
+	//drawn before the NULL check, so randomness used doesn't depend on it.
+	pos = vector_random_position(rng, 1.0f, 1.0f);
+	direction = vector_random_direction(rng);
 
 	if (obj == NULL) {
 		ILOG("cannot activate null object");
 		return NULL;
 	}
+	pos.x *= obj->store->worldW;
+	pos.y *= obj->store->worldH;
 
 	if (type == ASTEROID) {
 		size = ASTEROID_SIZE;
-		speed = ASTEROID_MAX_SPEED * random_float(1.0);
+		speed = ASTEROID_MAX_SPEED * random_float(rng, 1.0);
 	} else if (type == SHIP) {
 		size = SHIP_SIZE;
 		direction = vector_fixed_direction();
-		angle = random_angle();
+		angle = random_angle(rng);
 		direction = vector_rotate(direction, angle);
 	} else if (type == MISSILE) {
 		size.x = MISSILE_RADIUS;
@@ -122,45 +230,52 @@ Object* object_activate(Object *obj, uint32_t type, Color col) {
 
 /** CHECKS **/
 
-/* true iff object is destroyed */
-bool object_is_destroyed(Object *obj) {
-	return obj->destroyed > 0;
-}
-
-/* true iff objects is active */
-bool object_is_active(Object *obj) {
-	return obj->active;
-}
-
 /* true iff object is type t */
 bool object_is_type(Object *obj, ObjectType t) {
-	return obj->type == t;
+	return object_type(obj) == t;
 }
 
 /** GETTERS **/
 
 /* gets (x, y) of midpoint of object */
 Vector2 object_midpoint(Object *obj) {
-	Vector2 v = {obj->x + obj->w/2, obj->y + obj->h/2};
+	Vector2 v = {object_x(obj) + obj->w/2, object_y(obj) + obj->h/2};
 	return v;
 }
 
 /* gets object (x, y) */
 Vector2 object_position(Object *obj) {
-	Vector2 v = {obj->x, obj->y};
+	Vector2 v = {object_x(obj), object_y(obj)};
+	return v;
+}
+
+/* gets how far to shift drawing of object back towards
+ * where it was before its last move. alpha is how far we
+ * are into the next tick, 1.0 is no shift.
+ */
+Vector2 object_draw_offset(Object *obj, float alpha) {
+	Vector2 v = {
+		(obj->store->px[obj->id] - object_x(obj)) * (1.0f - alpha),
+		(obj->store->py[obj->id] - object_y(obj)) * (1.0f - alpha),
+	};
 	return v;
 }
 
+/* gets handle of player owning obj, OBJECT_NO_OWNER for none */
+uint32_t object_owner(Object *obj) {
+	return obj->owner;
+}
+
+/* sets handle of player owning obj */
+void object_set_owner(Object *obj, uint32_t owner) {
+	obj->owner = owner;
+}
+
 /* gets object color */
 Color object_color(Object *obj) {
 	return obj->col;
 }
 
-/* gets object type */
-ObjectType object_type(Object *obj) {
-	return obj->type;
-}
-
 /* gets direction */
 Vector2 object_direction(Object *obj) {
 	return obj->direction;
@@ -175,12 +290,12 @@ float object_speed(Object *obj) {
  * movement settings. inverted=true gets the previous
  * position. */
 Vector2 object_movement(Object *obj, bool inverted) {
-	Vector2 av = {obj->direction.x * obj->speed, obj->direction.y * obj->speed};
+	Vector2 av = {obj->store->vx[obj->id], obj->store->vy[obj->id]};
 	if (inverted) {
 		av.x = -av.x;
 		av.y = -av.y;
 	}
-	Vector2 res = {av.x + obj->x, av.y + obj->y};
+	Vector2 res = {av.x + object_x(obj), av.y + object_y(obj)};
 	return res;
 }
 
@@ -208,59 +323,150 @@ void object_rotate_points(Object *obj, Vector2 *pts, uint32_t n) {
 }
 
 /*
- * Returns coordinates of point definining edges of object.
+ * Calculates coordinates of point definining edges of object.
  * Point returned in pts.
  * Will set number of points in n if set, otherwise ignored.
  * Takes rotation uint32_to account.
+ * Use object_verts instead, which caches the result.
  */
-void object_get_points(Object *obj, Vector2 *pts, uint32_t *n) {
+void object_build_points(Object *obj, Vector2 *pts, uint32_t *n) {
 	uint32_t m = 0;
 	uint32_t *ms = (n == NULL) ? &m : n;
+	float x = object_x(obj), y = object_y(obj);
+	ObjectType type = object_type(obj);
 
-	if (obj->type == ASTEROID) {
+	if (type == ASTEROID) {
 		*ms = 4;
-		pts[0].x = obj->x;
-		pts[0].y = obj->y;
-		pts[1].x = obj->x + obj->w;
-		pts[1].y = obj->y;
-		pts[2].x = obj->x + obj->w;
-		pts[2].y = obj->y + obj->h;
-		pts[3].x = obj->x;
-		pts[3].y = obj->y + obj->h;
-
-	} else if (obj->type == SHIP) {
+		pts[0].x = x;
+		pts[0].y = y;
+		pts[1].x = x + obj->w;
+		pts[1].y = y;
+		pts[2].x = x + obj->w;
+		pts[2].y = y + obj->h;
+		pts[3].x = x;
+		pts[3].y = y + obj->h;
+
+	} else if (type == SHIP) {
 		*ms = 3;
-		pts[0].x = obj->x + obj->w/2;
-		pts[0].y = obj->y;
-		pts[1].x = obj->x;
-		pts[1].y = obj->y + obj->h/2;
-		pts[2].x = obj->x + obj->w;
-		pts[2].y = obj->y + obj->h;
+		pts[0].x = x + obj->w/2;
+		pts[0].y = y;
+		pts[1].x = x;
+		pts[1].y = y + obj->h/2;
+		pts[2].x = x + obj->w;
+		pts[2].y = y + obj->h;
 
 		//As of now, only ships rotate.
 		object_rotate_points(obj, pts, *ms);
 
-	} else if (obj->type == MISSILE) {
+	} else if (type == MISSILE) {
 		*ms = 1;
-		pts[0].x = obj->x;
-		pts[0].y = obj->y;
+		pts[0].x = x;
+		pts[0].y = y;
 
 	} else {
-		ILOG("cannot get points from unknown type %d", obj->type);
+		ILOG("cannot get points from unknown type %d", type);
+		*ms = 0;
 		return;
 	}
 }
 
+/*
+ * Calculates axis aligned box around n points of the object,
+ * as its top left and bottom right corners.
+ * Missiles also include their previous position, since they
+ * are checked for collisions along the line they travelled.
+ * With swept collisions, all objects include their box at
+ * their previous position.
+ */
+void object_build_bounds(Object *obj, Vector2 *pts, uint32_t n, Vector2 *lo, Vector2 *hi) {
+	Vector2 verts[5];
+	Vector2 zero = { 0 };
+
+	memcpy(verts, pts, n * sizeof(verts[0]));
+	if (object_is_type(obj, MISSILE)) {
+		verts[n++] = object_movement(obj, true);
+	}
+	if (n == 0) {
+		*lo = *hi = zero;
+		return;
+	}
+
+	float x0 = verts[0].x, y0 = verts[0].y, x1 = verts[0].x, y1 = verts[0].y;
+	for (uint32_t i = 1; i < n; i++) {
+		x0 = fminf(x0, verts[i].x);
+		y0 = fminf(y0, verts[i].y);
+		x1 = fmaxf(x1, verts[i].x);
+		y1 = fmaxf(y1, verts[i].y);
+	}
+	if (obj->store->swept) {
+		float dx = obj->store->px[obj->id] - object_x(obj);
+		float dy = obj->store->py[obj->id] - object_y(obj);
+		x0 = fminf(x0, x0 + dx);
+		y0 = fminf(y0, y0 + dy);
+		x1 = fmaxf(x1, x1 + dx);
+		y1 = fmaxf(y1, y1 + dy);
+	}
+	lo->x = x0;
+	lo->y = y0;
+	hi->x = x1;
+	hi->y = y1;
+}
+
+/* rebuilds cached points and bounds, if stale */
+void object_update_cache(Object *obj) {
+	if (obj->cached) {
+		return;
+	}
+	object_build_points(obj, obj->verts, &obj->nVerts);
+	object_build_bounds(obj, obj->verts, obj->nVerts, &obj->lo, &obj->hi);
+	obj->cached = true;
+}
+
+/*
+ * Returns points definining edges of object, rotated.
+ * Points are cached on the object, and only recalculated
+ * after it moves or turns. Sets number of points in n.
+ * NB: points change when object does, copy them to keep them.
+ */
+const Vector2* object_verts(Object *obj, uint32_t *n) {
+	object_update_cache(obj);
+	*n = obj->nVerts;
+	return obj->verts;
+}
+
+/*
+ * Copies points definining edges of object into pts.
+ * Will set number of points in n if set, otherwise ignored.
+ */
+void object_get_points(Object *obj, Vector2 *pts, uint32_t *n) {
+	uint32_t m = 0;
+	const Vector2 *verts = object_verts(obj, &m);
+	memcpy(pts, verts, m * sizeof(pts[0]));
+	if (n != NULL) {
+		*n = m;
+	}
+}
+
+/* Returns axis aligned box around all the points of the object.
+ * Cached like points, see object_verts. */
+Rectangle object_bounds(Object *obj) {
+	object_update_cache(obj);
+	Rectangle rec = {obj->lo.x, obj->lo.y, obj->hi.x - obj->lo.x, obj->hi.y - obj->lo.y};
+	return rec;
+}
+
 /** SETTERS **/
 
 /* sets object X coord */
 void object_set_x(Object *obj, float newX) {
-	obj->x = newX;
+	obj->store->x[obj->id] = newX;
+	object_invalidate(obj);
 }
 
 /* sets object Y coord */
 void object_set_y(Object *obj, float newY) {
-	obj->y = newY;
+	obj->store->y[obj->id] = newY;
+	object_invalidate(obj);
 	//obj->direction.y = -obj->direction.y;
 }
 
@@ -277,6 +483,7 @@ void object_adjust_angle(Object *obj, float amount) {
 	if (obj->angle < 0) {
 		obj->angle += 360;
 	}
+	object_invalidate(obj);
 }
 
 /*
@@ -285,6 +492,15 @@ void object_adjust_angle(Object *obj, float amount) {
 void object_adjust_direction(Object *obj, float amount) {
 	object_adjust_angle(obj, amount);
 	obj->direction = vector_rotate(obj->direction, amount);
+	object_update_velocity(obj);
+}
+
+/*
+ * sets objects direction, without changing its angle.
+ */
+void object_set_direction(Object *obj, Vector2 direction) {
+	obj->direction = direction;
+	object_update_velocity(obj);
 }
 
 /*
@@ -296,6 +512,7 @@ void object_adjust_speed(Object *obj, float amount) {
 	if (obj->speed < 0) {
 		obj->speed = 0;
 	}
+	object_update_velocity(obj);
 }
 
 /** UNINIT **/
@@ -304,7 +521,7 @@ void object_adjust_speed(Object *obj, float amount) {
  * returns true iff set, false if already destroyed. */
 bool object_destroy(Object *obj) {
 	if (!object_is_destroyed(obj)) {
-		obj->destroyed = 1;
+		object_set_destroyed(obj, 1);
 		return true;
 	}
 	return false;
@@ -312,28 +529,120 @@ bool object_destroy(Object *obj) {
 
 /** increments object destroy counter and returns postfix */
 uint32_t object_increment_destroy(Object *obj) {
-	return obj->destroyed++;
+	uint32_t prev = obj->destroyed;
+	object_set_destroyed(obj, prev + 1);
+	return prev;
 }
 
 /* sets deactivation state on object, allows object to be
  * re-assigned. Also "undestroys it" */
 void object_deactivate(Object *obj) {
 	if (obj == NULL) { return; }
-	obj->active = 0;
-	obj->destroyed = 0;
+	object_set_active(obj, false);
+	object_set_destroyed(obj, 0);
 	object_debug(obj, "deactivated");
 }
 
+/* re-activates obj as destroyed, so it gets respawned. */
+void object_mark_respawn(Object *obj) {
+	if (obj == NULL) { return; }
+	object_set_active(obj, true);
+	object_set_destroyed(obj, 1);
+}
+
 /** COLLISION DETECTION **/
 
-/* true iff o1 collides with o2 */
+/* true iff bounds of o1 and o2 overlap, edges included.
+ * Objects can't collide unless they do, since every point
+ * that is tested lies within its object's bounds. */
+bool object_is_bounds_overlapping(Object *o1, Object *o2) {
+	object_update_cache(o1);
+	object_update_cache(o2);
+	return o1->lo.x <= o2->hi.x && o2->lo.x <= o1->hi.x &&
+		o1->lo.y <= o2->hi.y && o2->lo.y <= o1->hi.y;
+}
+
+/* gets box around object's points, not including where it moved from. */
+void object_shape_box(Object *obj, Vector2 *lo, Vector2 *hi) {
+	uint32_t n;
+	const Vector2 *verts = object_verts(obj, &n);
+	Vector2 zero = { 0 };
+
+	*lo = *hi = n > 0 ? verts[0] : zero;
+	for (uint32_t i = 1; i < n; i++) {
+		lo->x = fminf(lo->x, verts[i].x);
+		lo->y = fminf(lo->y, verts[i].y);
+		hi->x = fmaxf(hi->x, verts[i].x);
+		hi->y = fmaxf(hi->y, verts[i].y);
+	}
+}
+
+/*
+ * Narrows [sIn, sOut] to the part of a move where two boxes overlap
+ * on one axis. Box a spans [aLo, aHi] and b [bLo, bHi] after the move,
+ * s is how far back along it, with a offset by -s * d relative to b.
+ */
+void object_sweep_axis(float aLo, float aHi, float bLo, float bHi, float d, float *sIn, float *sOut) {
+	if (d == 0) {
+		if (aLo > bHi || bLo > aHi) {
+			*sIn = 1;
+			*sOut = 0;
+		}
+		return;
+	}
+	float s0 = (aLo - bHi) / d;
+	float s1 = (aHi - bLo) / d;
+	if (s0 > s1) {
+		float tmp = s0;
+		s0 = s1;
+		s1 = tmp;
+	}
+	*sIn = fmaxf(*sIn, s0);
+	*sOut = fminf(*sOut, s1);
+}
+
+/*
+ * Time of impact test, true iff boxes around o1 and o2 touched at
+ * any point during their last moves, from previous to current position.
+ * Both moves are taken to happen at the same time. Boxes are around
+ * the object's points, so ships' triangles are a bit generous.
+ * Used for swept collisions, so fast objects can't pass through
+ * each other between ticks. Counts checks in the store.
+ */
+bool object_is_sweep_colliding(Object *o1, Object *o2) {
+	Vector2 aLo, aHi, bLo, bHi;
+	float sIn = 0, sOut = 1;
+
+	if (!object_is_active(o1) || !object_is_active(o2) || o1 == o2) {
+		return false;
+	}
+	if (!object_is_bounds_overlapping(o1, o2)) {
+		return false;
+	}
+	//counted as narrow phase work like object_is_colliding's. The pair
+	//itself was already counted there, sweeps only run after it.
+	o1->store->nNarrowTests++;
+
+	ObjectStore *store = o1->store;
+	float dx = (object_x(o1) - store->px[o1->id]) - (object_x(o2) - store->px[o2->id]);
+	float dy = (object_y(o1) - store->py[o1->id]) - (object_y(o2) - store->py[o2->id]);
+
+	object_shape_box(o1, &aLo, &aHi);
+	object_shape_box(o2, &bLo, &bHi);
+	object_sweep_axis(aLo.x, aHi.x, bLo.x, bHi.x, dx, &sIn, &sOut);
+	object_sweep_axis(aLo.y, aHi.y, bLo.y, bHi.y, dy, &sIn, &sOut);
+	return sIn <= sOut;
+}
+
+/* true iff o1 collides with o2.
+ * Checks bounds first, and counts checks in the store. */
 bool object_is_colliding(Object *o1, Object *o2) {
-	Vector2 verts[4];
+	const Vector2 *verts;
 	Vector2 prev;
 	Vector2 point;
 	uint32_t n = 0;
 
-	if (!o1->active || !o2->active) {
+	if (!object_is_active(o1) || !object_is_active(o2)) {
 		return false;
 	}
 
@@ -341,7 +650,13 @@ bool object_is_colliding(Object *o1, Object *o2) {
 		return false;
 	}
 
-	object_get_points(o1, verts, &n);
+	o1->store->nPairTests++;
+	if (!object_is_bounds_overlapping(o1, o2)) {
+		return false;
+	}
+	o1->store->nNarrowTests++;
+
+	verts = object_verts(o1, &n);
 	if (n == 0) {
 		return false;
 	}
@@ -350,23 +665,21 @@ bool object_is_colliding(Object *o1, Object *o2) {
 
 	for (uint32_t i = 0; i < n; i++) {
 		point = verts[i];
-		if (o2->type == ASTEROID) {
-			Rectangle rec = {o2->x, o2->y, o2->w, o2->h};
+		if (object_is_type(o2, ASTEROID)) {
+			Rectangle rec = {object_x(o2), object_y(o2), o2->w, o2->h};
 			if (CheckCollisionPointRec(point, rec)) {
 				DLOG("asteroid collision");
 				return true;
 			}
-		} else if (o2->type == SHIP) {
-			Vector2 tv[3];
-			object_get_points(o2, tv, NULL);
+		} else if (object_is_type(o2, SHIP)) {
+			uint32_t nt;
+			const Vector2 *tv = object_verts(o2, &nt);
 			if (CheckCollisionPointTriangle(point, tv[0], tv[1], tv[2])) {
 				DLOG("ship collision");
 				return true;
 			}
-		} else if (o2->type == MISSILE) {
-			Vector2 missile;
-			missile.x = o2->x;
-			missile.y = o2->y;
+		} else if (object_is_type(o2, MISSILE)) {
+			Vector2 missile = object_position(o2);
 			if (vector_is_equal(point, missile)) {
 				DLOG("missile vector");
 				return true;
@@ -377,7 +690,7 @@ bool object_is_colliding(Object *o1, Object *o2) {
 				return true;
 			}
 		} else {
-			ILOG("cannot check collisions for unknown type %d", o2->type);
+			ILOG("cannot check collisions for unknown type %d", object_type(o2));
 		}
 		prev = point;
 	}
@@ -386,34 +699,36 @@ bool object_is_colliding(Object *o1, Object *o2) {
 
 /* moves an object to it's next coordinate */
 void object_advance(Object *obj) {
-	if (obj == NULL || !obj->active) { return; }
-	Vector2 verts[4];
+	if (obj == NULL || !object_is_active(obj)) { return; }
+	const Vector2 *verts;
 	uint32_t n;
 	Vector2 mvmt = object_movement(obj, false);
 
-	obj->x = mvmt.x;
-	obj->y = mvmt.y;
+	object_settle(obj);
+	object_set_x(obj, mvmt.x);
+	object_set_y(obj, mvmt.y);
 
-	//handles obj falling off screen
-	object_get_points(obj, verts, &n);
+	//handles obj falling off the world
+	verts = object_verts(obj, &n);
 	uint32_t buf = 5;
+	float worldW = obj->store->worldW, worldH = obj->store->worldH;
 
 	for (uint32_t i = 0; i < n; i++) {
 		Vector2 point = verts[i];
 		bool isOffscreen = false;
 		if (point.x < 0) {
-			object_set_x(obj, SCREEN_W - obj->w - buf);
+			object_set_x(obj, worldW - obj->w - buf);
 			isOffscreen = true;
 		}
-		if (point.x > SCREEN_W) {
+		if (point.x > worldW) {
 			object_set_x(obj, buf);
 			isOffscreen = true;
 		}
 		if (point.y < 0) {
-			object_set_y(obj, SCREEN_H - obj->h - buf);
+			object_set_y(obj, worldH - obj->h - buf);
 			isOffscreen = true;
 		}
-		if (point.y > SCREEN_H) {
+		if (point.y > worldH) {
 			object_set_y(obj, buf);
 			isOffscreen = true;
 		}
@@ -423,6 +738,7 @@ void object_advance(Object *obj) {
 			if (object_is_type(obj, MISSILE)) {
 				object_destroy(obj);
 			}
+			object_settle(obj);
 			break; //no need for further checks
 		}
 	}
@@ -430,28 +746,67 @@ void object_advance(Object *obj) {
 
 /** DRAWING **/
 
-/* draws object based on type */
-void object_draw(Object *obj) {
-	Color col = obj->col;
-	if (object_is_destroyed(obj)) {
-		col = RED;
+/* gets color obj is drawn in, red while being destroyed */
+Color object_draw_color(Object *obj) {
+	return object_is_destroyed(obj) ? RED : obj->col;
+}
+
+/*
+ * Writes corners of the shape drawn for obj, alpha of the way
+ * between ticks, to out, which must fit 4 points.
+ * Missiles are drawn as tiny circles, so are given as the square
+ * around them. Returns number of corners, 0 for unknown types.
+ */
+uint32_t object_draw_polygon(Object *obj, float alpha, Vector2 *out) {
+	Vector2 offset = object_draw_offset(obj, alpha);
+	float x = object_x(obj) + offset.x, y = object_y(obj) + offset.y;
+	float w = obj->w, h = obj->h;
+
+	if (object_is_type(obj, SHIP)) {
+		uint32_t n;
+		const Vector2 *verts = object_verts(obj, &n);
+		for (uint32_t i = 0; i < n; i++) {
+			out[i] = vector_add(verts[i], offset);
+		}
+		return n;
+	}
+	if (object_is_type(obj, MISSILE)) {
+		x -= w;
+		y -= w;
+		w *= 2;
+		h = w;
+	} else if (!object_is_type(obj, ASTEROID)) {
+		return 0;
 	}
-	if (obj->type == ASTEROID) {
-		DrawRectangleLines(obj->x, obj->y, obj->w, obj->h, col);  // NOTE: Uses QUADS uint32_ternally, not lines
+	//counter-clockwise on screen, so filled shapes aren't culled as back faces
+	Vector2 corners[4] = {{x, y}, {x, y + h}, {x + w, y + h}, {x + w, y}};
+	memcpy(out, corners, sizeof(corners));
+	return 4;
+}
+
+/* draws object based on type.
+ * alpha is how far we are between the last tick and the next,
+ * used to draw the object partway along its last move.
+ * See render.c for drawing many objects at once. */
+void object_draw(Object *obj, float alpha) {
+	Color col = object_draw_color(obj);
+	Vector2 offset = object_draw_offset(obj, alpha);
+	if (object_is_type(obj, ASTEROID)) {
+		DrawRectangleLines(object_x(obj) + offset.x, object_y(obj) + offset.y, obj->w, obj->h, col);  // NOTE: Uses QUADS uint32_ternally, not lines
 		//DrawPoly(objPos(obj), 4, obj->w, obj->angle, col);
-	} else if (obj->type == SHIP) {
-		Vector2 verts[3];
-		object_get_points(obj, verts, NULL);
+	} else if (object_is_type(obj, SHIP)) {
+		uint32_t n;
+		const Vector2 *verts = object_verts(obj, &n);
 		//DrawPoly(verts[0], 3, obj->w, obj->angle, col);
 		DrawTriangleLines(
-				verts[0],
-				verts[1],
-				verts[2],
+				vector_add(verts[0], offset),
+				vector_add(verts[1], offset),
+				vector_add(verts[2], offset),
 			col);
-	} else if (obj->type == MISSILE) {
-		DrawCircle(obj->x, obj->y, obj->w, col);
+	} else if (object_is_type(obj, MISSILE)) {
+		DrawCircle(object_x(obj) + offset.x, object_y(obj) + offset.y, obj->w, col);
 	} else {
-		ILOG("cannot draw unrecognized type %d", obj->type);
+		ILOG("cannot draw unrecognized type %d", object_type(obj));
 	}
 	object_debug(obj, "drew");
 }
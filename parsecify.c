@@ -5,14 +5,21 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 
 #include "parsec.h"
 #include "raylib.h"
 
 #include "types.h"
+#include "inputqueue.c"
+#include "profile.c"
 
-/* sends frame to parsec for distribution if parsec is initialized */
-void parsecify_submit_frame(Parsec *parsec) {
+/* sends frame to parsec for distribution if parsec is initialized.
+ * The texture is handed over as is, it is already stored bottom up
+ * the way GL (and parsec) expect, so no copying or flipping needed. */
+void parsecify_submit_frame(Parsec *parsec, Texture2D frame) {
   if (parsec == NULL) {
     return;
 	}
@@ -23,12 +30,7 @@ void parsecify_submit_frame(Parsec *parsec) {
   if (n_guests > 0) {
 		DLOG("one guest connected");
 		assert(guests);
-    Image image = GetScreenData();
-    ImageFlipVertical(&image);
-    Texture2D tex = LoadTextureFromImage(image);
-    ParsecHostGLSubmitFrame(parsec, tex.id);
-		UnloadImage(image);
-		UnloadTexture(tex);
+    ParsecHostGLSubmitFrame(parsec, frame.id);
 		ParsecFree(guests);
   } else {
 		DLOG("No guests");
@@ -59,23 +61,6 @@ bool parsecify_state_change(GameState *state, ParsecGuest *guest) {
 	return playerAdded;
 }
 
-/* parsec event check loop. */
-bool parsecify_check_events(Parsec *parsec, GameState *state) {
-	bool playerAdded = false;
-	assert(parsec);
-	assert(state);
-	if (parsec != NULL) {
-		for (ParsecHostEvent event; ParsecHostPollEvents(parsec, 0, &event);) {
-			if (event.type == HOST_EVENT_GUEST_STATE_CHANGE)
-				if (parsecify_state_change(state, &event.guestStateChange.guest)) {
-					playerAdded = true;
-				}
-		}
-	}
-
-	return playerAdded;
-}
-
 /* translates parsec input into player state */
 void parsecify_handle_input_message(GameState *state, ParsecGuest *guest, ParsecMessage *msg) {
 	assert(state);
@@ -83,40 +68,46 @@ void parsecify_handle_input_message(GameState *state, ParsecGuest *guest, Parsec
 	assert(msg);
 	Player *p = game_get_player_from_guest(state, guest);
 	bool pressed = false;
+	uint32_t bits = 0; //PRESS_ bits the message is for, none if unmapped
+
+	if (p == NULL) {
+		DLOG("[%d] input from guest with no player", guest->id);
+		return;
+	}
 
 	if (msg->type == MESSAGE_KEYBOARD) {
 		pressed = msg->keyboard.pressed;
 		DLOG("[%d] keyboard event: %i", guest->id, pressed);
 		switch (msg->keyboard.code) {
 			case PARSEC_KEY_W:
-				p->p_w = pressed;
+				bits = PRESS_W;
 				break;
 			case PARSEC_KEY_UP:
-				p->p_up = pressed;
+				bits = PRESS_UP;
 				break;
 			case PARSEC_KEY_S:
-				p->p_s = pressed;
+				bits = PRESS_S;
 				break;
 			case PARSEC_KEY_DOWN:
-				p->p_up = pressed;
+				bits = PRESS_DOWN;
 				break;
 			case PARSEC_KEY_A:
-				p->p_a = pressed;
+				bits = PRESS_A;
 				break;
 			case PARSEC_KEY_LEFT:
-				p->p_left = pressed;
+				bits = PRESS_LEFT;
 				break;
 			case PARSEC_KEY_D:
-				p->p_d = pressed;
+				bits = PRESS_D;
 				break;
 			case PARSEC_KEY_RIGHT:
-				p->p_right = pressed;
+				bits = PRESS_RIGHT;
 				break;
 			case PARSEC_KEY_SPACE:
-				p->p_space = pressed;
+				bits = PRESS_SPACE;
 				break;
 			case PARSEC_KEY_Q:
-				p->p_q = pressed;
+				bits = PRESS_Q;
 				break;
 			default:
 				DLOG("unrecognized keyboard");
@@ -127,31 +118,31 @@ void parsecify_handle_input_message(GameState *state, ParsecGuest *guest, Parsec
 		DLOG("[%i] gamepad button event: %i", guest->id, pressed);
 		switch (msg->gamepadButton.button) {
 			case GAMEPAD_BUTTON_DPAD_UP:
-				p->p_g_up = pressed;
+				bits = PRESS_G_UP;
 				break;
 			case GAMEPAD_BUTTON_DPAD_DOWN:
-				p->p_g_down = pressed;
+				bits = PRESS_G_DOWN;
 				break;
 			case GAMEPAD_BUTTON_DPAD_LEFT:
-				p->p_g_left = pressed;
+				bits = PRESS_G_LEFT;
 				break;
 			case GAMEPAD_BUTTON_DPAD_RIGHT:
-				p->p_g_right = pressed;
+				bits = PRESS_G_RIGHT;
 				break;
 			case GAMEPAD_BUTTON_A:
-				p->p_g_a = pressed;
+				bits = PRESS_G_A;
 				break;
 			case GAMEPAD_BUTTON_B:
-				p->p_g_b = pressed;
+				bits = PRESS_G_B;
 				break;
 			case GAMEPAD_BUTTON_X:
-				p->p_g_x = pressed;
+				bits = PRESS_G_X;
 				break;
 			case GAMEPAD_BUTTON_LSHOULDER:
-				p->p_g_lt = pressed;
+				bits = PRESS_G_LT;
 				break;
 			case GAMEPAD_BUTTON_RSHOULDER:
-				p->p_g_rt = pressed;
+				bits = PRESS_G_RT;
 				break;
 			default:
 				DLOG("unrecognized gamepad");
@@ -162,18 +153,86 @@ void parsecify_handle_input_message(GameState *state, ParsecGuest *guest, Parsec
 	//} else if (msg->type == MESSAGE_GAMEPAD_AXIS) {
 	//	ParsecGamepadAxisMessage *pm = &msg->gamepadAxis;
 	}
+	player_set_press(p, bits, pressed);
 }
 
-/* Checks Parsec Inputs */
-void parsecify_check_input(Parsec *parsec, GameState *state) {
-	if (parsec == NULL) {
+/* queues ev for the tick, waiting while the queue is full.
+ * Input isn't dropped, a lost key release would leave it held. */
+void parsecify_queue_input(InputThread *input, InputEvent *ev) {
+	ev->received = profile_now();
+	while (!inputqueue_push(&input->queue, ev)) {
+		atomic_fetch_add(&input->queue.nStalls, 1);
+		if (!atomic_load(&input->running)) {
+			return;
+		}
+		sched_yield();
+	}
+}
+
+/* Input thread. Polls parsec events and input into the queue until
+ * stopped, waiting on input so it doesn't spin while there is none. */
+void* parsecify_input_thread(void *arg) {
+	InputThread *input = arg;
+	InputEvent ev = { 0 };
+
+	while (atomic_load(&input->running)) {
+		for (ParsecHostEvent event; ParsecHostPollEvents(input->parsec, 0, &event);) {
+			if (event.type == HOST_EVENT_GUEST_STATE_CHANGE) {
+				ev.type = INPUT_GUEST_STATE;
+				ev.guest = event.guestStateChange.guest;
+				parsecify_queue_input(input, &ev);
+			}
+		}
+		if (ParsecHostPollInput(input->parsec, INPUT_POLL_TIMEOUT_MS, &ev.guest, &ev.msg)) {
+			ev.type = INPUT_MESSAGE;
+			parsecify_queue_input(input, &ev);
+		}
+	}
+	return NULL;
+}
+
+/* starts polling parsec on its own thread.
+ * returns true on failure, false otherwise. */
+bool parsecify_start_input(InputThread *input, Parsec *parsec) {
+	input->parsec = parsec;
+	atomic_store(&input->running, true);
+	if (pthread_create(&input->thread, NULL, parsecify_input_thread, input) != 0) {
+		ILOG("couldn't start input thread");
+		atomic_store(&input->running, false);
+		return true;
+	}
+	return false;
+}
+
+/* stops the input thread, if running. Anything still queued is dropped. */
+void parsecify_stop_input(InputThread *input) {
+	if (!atomic_load(&input->running)) {
 		return;
 	}
+	atomic_store(&input->running, false);
+	pthread_join(input->thread, NULL);
+	ILOG("input queue was full %u times", atomic_load(&input->queue.nStalls));
+}
+
+/*
+ * Applies guest changes and input queued by the input thread, in the
+ * order they came in. Time from polling to applying is recorded in
+ * PROFILE_INPUT_LATENCY. Returns true iff a player was added.
+ */
+bool parsecify_drain_input(InputThread *input, GameState *state) {
+	bool playerAdded = false;
 	assert(state);
-	ParsecGuest guest;
-	for (ParsecMessage msg; ParsecHostPollInput(parsec, 0, &guest, &msg);) {
-		parsecify_handle_input_message(state, &guest, &msg);
+	for (InputEvent ev; inputqueue_pop(&input->queue, &ev);) {
+		if (ev.type == INPUT_GUEST_STATE) {
+			if (parsecify_state_change(state, &ev.guest)) {
+				playerAdded = true;
+			}
+		} else {
+			parsecify_handle_input_message(state, &ev.guest, &ev.msg);
+		}
+		profile_record(&state->profiler, PROFILE_INPUT_LATENCY, profile_now() - ev.received);
 	}
+	return playerAdded;
 }
 
 /* kicks a player */
@@ -210,8 +269,9 @@ void parsecify_deinit(Parsec *parsec, GameState *state) {
 		return;
 	}
 	assert(state);
+	parsecify_stop_input(&state->parsecInput);
 
-	for (uint32_t i = 0; i < MAX_PLAYERS; i++) {
+	for (uint32_t i = 0; i < state->limits.maxPlayers; i++) {
 		Player *player = &state->players[i];
 		if (player->active) {
 			parsecify_kick_guest(state->parsec, player);
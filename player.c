@@ -17,7 +17,7 @@ void player_adjust_score(Player *p, uint32_t amount) {
 /* true iff player wants to reset game */
 bool player_is_reset_requested(Player *p) {
 	if (p == NULL) { return false; }
-	return p->p_q || (p->p_g_lt && p->p_g_rt);
+	return (p->presses & PRESS_Q) || (p->presses & (PRESS_G_LT | PRESS_G_RT)) == (PRESS_G_LT | PRESS_G_RT);
 }
 
 /* sets player fields to 0 if pointer is not null */
@@ -28,6 +28,15 @@ void player_clear(Player *p) {
 	}
 }
 
+/* clears player for someone new taking its slot. generation is
+ * bumped, so handles to the last player in the slot go stale. */
+void player_renew(Player *p) {
+	uint16_t generation = p->generation + 1;
+	if (generation == 0) { generation = 1; } //0 is never a generation, so handles aren't OBJECT_NO_OWNER
+	player_clear(p);
+	p->generation = generation;
+}
+
 /* true iff player is not null and has active bit set */
 bool player_is_active(Player *p) {
 	return p != NULL && p->active;
@@ -57,6 +66,12 @@ Object *player_ship(Player *p) {
 	return p->ship;
 }
 
+/* gets player presses, as PRESS_ bits */
+uint32_t player_get_presses(Player *p) {
+	assert(p);
+	return p->presses;
+}
+
 /* SETTERS / DEINIT */
 
 /* sets player color to c */
@@ -65,6 +80,22 @@ void player_set_color(Player *p, Color c) {
 	p->col = c;
 }
 
+/* sets player presses from PRESS_ bits */
+void player_set_presses(Player *p, uint32_t bits) {
+	assert(p);
+	p->presses = bits;
+}
+
+/* sets or clears PRESS_ bits, as keys or buttons go down or up */
+void player_set_press(Player *p, uint32_t bits, bool pressed) {
+	assert(p);
+	if (pressed) {
+		p->presses |= bits;
+	} else {
+		p->presses &= ~bits;
+	}
+}
+
 /* sets player guest to g */
 void player_set_guest(Player *p, ParsecGuest *g) {
 	assert(p);
@@ -92,9 +123,7 @@ void player_reset(Player *p) {
 	assert(p);
 	if (!player_is_active(p)) { return; }
 	if (p->ship != NULL) {
-		//Todo: do with getters/setters ?
-		p->ship->destroyed = true;
-		p->ship->active = true;
+		object_mark_respawn(p->ship);
 	}
 	p->score = 0;
 }
@@ -0,0 +1,176 @@
+/*
+ * Low overhead profiler for stages of the game loop.
+ * Stages are timed with a monotonic clock, and the last
+ * PROFILE_WINDOW samples of each stage are kept so we can
+ * show rolling min/avg/p99, on screen or dumped to a file.
+ */
+#ifndef PROFILE_C
+#define PROFILE_C
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "types.h"
+#include "raylib.h"
+
+/* returns monotonic time in nanoseconds */
+uint64_t profile_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* adds a sample of ns nanoseconds to stage */
+void profile_record(Profiler *prof, ProfileStage stage, uint64_t ns) {
+	prof->samples[stage][prof->next[stage]] = ns;
+	prof->next[stage] = (prof->next[stage] + 1) % PROFILE_WINDOW;
+	if (prof->n[stage] < PROFILE_WINDOW) {
+		prof->n[stage]++;
+	}
+	prof->total[stage] += ns;
+	prof->count[stage]++;
+	if (ns > prof->worst[stage]) {
+		prof->worst[stage] = ns;
+	}
+}
+
+/* starts timing stage */
+void profile_begin(Profiler *prof, ProfileStage stage) {
+	prof->started[stage] = profile_now();
+}
+
+/* stops timing stage, and records how long it took */
+void profile_end(Profiler *prof, ProfileStage stage) {
+	profile_record(prof, stage, profile_now() - prof->started[stage]);
+}
+
+/* orders samples for qsort */
+int profile_compare(const void *a, const void *b) {
+	uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+	return (x > y) - (x < y);
+}
+
+/* returns min/avg/p99 of the samples in the window for stage, in microseconds */
+ProfileStats profile_stats(Profiler *prof, ProfileStage stage) {
+	uint64_t sorted[PROFILE_WINDOW];
+	uint64_t sum = 0;
+	uint32_t n = prof->n[stage];
+	ProfileStats stats = { 0 };
+
+	if (n == 0) {
+		return stats;
+	}
+	memcpy(sorted, prof->samples[stage], n * sizeof(sorted[0]));
+	qsort(sorted, n, sizeof(sorted[0]), profile_compare);
+	for (uint32_t i = 0; i < n; i++) {
+		sum += sorted[i];
+	}
+
+	stats.n = n;
+	stats.min = sorted[0] / 1e3;
+	stats.avg = sum / (double)n / 1e3;
+	stats.p99 = sorted[(n - 1) * 99 / 100] / 1e3;
+	return stats;
+}
+
+/* records collision checks of a tick, see ObjectStore */
+void profile_collisions(Profiler *prof, uint32_t pairTests, uint32_t narrowTests) {
+	prof->tickPairTests = pairTests;
+	prof->tickNarrowTests = narrowTests;
+	prof->pairTests += pairTests;
+	prof->narrowTests += narrowTests;
+}
+
+/* records population after a tick, and keeps peaks */
+void profile_population(Profiler *prof, GameStats stats) {
+	prof->tickStats = stats;
+	if (stats.nLive > prof->peakLive) {
+		prof->peakLive = stats.nLive;
+	}
+	if (stats.nPlayers > prof->peakPlayers) {
+		prof->peakPlayers = stats.nPlayers;
+	}
+}
+
+/* records how many of live objects were drawn in a frame, after culling,
+ * in how many draw calls, and whether they were batched. */
+void profile_drawn(Profiler *prof, uint32_t drawn, uint32_t live, uint32_t calls, bool batched) {
+	prof->frameDrawn = drawn;
+	prof->frameLive = live;
+	prof->frameDrawCalls = calls;
+	prof->frameBatched = batched;
+}
+
+/* percentage of collision checks rejected by bounds, over all ticks */
+double profile_reject_rate(Profiler *prof) {
+	if (prof->pairTests == 0) {
+		return 0;
+	}
+	return 100.0 * (prof->pairTests - prof->narrowTests) / prof->pairTests;
+}
+
+/* draws stats for all stages at (x, y). Stats are only recalculated
+ * every PROFILE_REFRESH calls, so the overlay is cheap and readable. */
+void profile_draw(Profiler *prof, int x, int y) {
+	char text[96];
+	const int fontSize = 16;
+
+	if (prof->sinceRefresh == 0) {
+		for (uint32_t s = 0; s < N_PROFILE_STAGES; s++) {
+			prof->shown[s] = profile_stats(prof, s);
+		}
+	}
+	prof->sinceRefresh = (prof->sinceRefresh + 1) % PROFILE_REFRESH;
+
+	DrawText("stage          min     avg     p99 (us)", x, y, fontSize, GREEN);
+	for (uint32_t s = 0; s < N_PROFILE_STAGES; s++) {
+		ProfileStats *stats = &prof->shown[s];
+		snprintf(text, sizeof(text), "%-12s %7.1f %7.1f %7.1f",
+				PROFILE_STAGE_NAMES[s], stats->min, stats->avg, stats->p99);
+		DrawText(text, x, y + (s + 1) * fontSize, fontSize, GREEN);
+	}
+	snprintf(text, sizeof(text), "collisions %u checked %u narrow (%.1f%% rejected)",
+			prof->tickPairTests, prof->tickNarrowTests, profile_reject_rate(prof));
+	DrawText(text, x, y + (N_PROFILE_STAGES + 1) * fontSize, fontSize, GREEN);
+	snprintf(text, sizeof(text), "drawn %u of %u objects in %u %s", prof->frameDrawn, prof->frameLive,
+			prof->frameDrawCalls, prof->frameBatched ? "batches" : "draws");
+	DrawText(text, x, y + (N_PROFILE_STAGES + 2) * fontSize, fontSize, GREEN);
+	GameStats *stats = &prof->tickStats;
+	snprintf(text, sizeof(text), "%u players, %u of %u objects: %u ships %u asteroids %u missiles",
+			stats->nPlayers, stats->nLive, stats->capacity,
+			stats->nType[SHIP], stats->nType[ASTEROID], stats->nType[MISSILE]);
+	DrawText(text, x, y + (N_PROFILE_STAGES + 3) * fontSize, fontSize, GREEN);
+}
+
+/* writes stats for all stages to path.
+ * returns true on failure, false otherwise. */
+bool profile_dump(Profiler *prof, const char *path) {
+	FILE *f = fopen(path, "w");
+	if (f == NULL) {
+		ILOG("couldn't open profile file %s", path);
+		return true;
+	}
+
+	fprintf(f, "# last %u samples: min avg p99, all samples: count mean max. times in us\n", PROFILE_WINDOW);
+	fprintf(f, "%-14s %10s %10s %10s %10s %10s %10s\n", "stage", "min", "avg", "p99", "count", "mean", "max");
+	for (uint32_t s = 0; s < N_PROFILE_STAGES; s++) {
+		ProfileStats stats = profile_stats(prof, s);
+		double mean = prof->count[s] ? prof->total[s] / (double)prof->count[s] / 1e3 : 0;
+		fprintf(f, "%-14s %10.2f %10.2f %10.2f %10llu %10.2f %10.2f\n",
+				PROFILE_STAGE_NAMES[s], stats.min, stats.avg, stats.p99,
+				(unsigned long long)prof->count[s], mean, prof->worst[s] / 1e3);
+	}
+	fprintf(f, "# collision checks: %llu, narrow phase: %llu, rejected by bounds: %.2f%%\n",
+			(unsigned long long)prof->pairTests, (unsigned long long)prof->narrowTests,
+			profile_reject_rate(prof));
+	fprintf(f, "# peak objects: %u of %u, peak players: %u\n",
+			prof->peakLive, prof->tickStats.capacity, prof->peakPlayers);
+	fclose(f);
+	return false;
+}
+
+#endif /* PROFILE_C */
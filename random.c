@@ -1,5 +1,8 @@
 /* Utility library for randomization.
- * All assume uniforme probability distribution. */
+ * All assume uniforme probability distribution.
+ * Uses xoshiro128** (https://prng.di.unimi.it/), seeded explicitly
+ * and kept on the game state, so runs with the same seed
+ * are the same on every machine. */
 #ifndef RANDOM_C
 #define RANDOM_C
 
@@ -9,48 +12,79 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-/* returns a float in the range (0.0, a) */
-float random_float(float a) {
-	float res = (float)rand()/((float)(RAND_MAX/a));
+#include "types.h"
+
+/* rotates x left by k bits */
+uint32_t random_rotl(uint32_t x, int k) {
+	return (x << k) | (x >> (32 - k));
+}
+
+/* returns next 32 random bits */
+uint32_t random_next(Random *rng) {
+	uint32_t *s = rng->s;
+	uint32_t res = random_rotl(s[1] * 5, 7) * 9;
+	uint32_t t = s[1] << 9;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = random_rotl(s[3], 11);
+
+	return res;
+}
+
+/* returns a float in the range (0.0, a] */
+float random_float(Random *rng, float a) {
+	//top 24 bits fit exactly in a float's mantissa, +1 excludes 0.
+	float res = ((random_next(rng) >> 8) + 1) * (1.0f / 16777216.0f) * a;
 	assert(res > 0.0);
 	assert(res <= a);
 	return  res;
 }
 
 /* returns true with probability a */
-bool random_prob(float a) {
-	uint32_t res = rand();
-	return (float)res < RAND_MAX * a;
-}
-
-/* returns an int in the range (0, n) (non-inclusive) */
-uint32_t random_uint32_t(uint32_t n) {
-	uint32_t res = rand();
-	uint32_t chunk = RAND_MAX / n;
-	uint32_t i = 0;
-
-	//We iterate until result is larger than the chunk
-	//cutoff (i+1), at which point we know we are in that i.
-	for (; i < n; i++) {
-		if (res < chunk * (i+1)) {
-			break;
+bool random_prob(Random *rng, float a) {
+	return (random_next(rng) >> 8) * (1.0f / 16777216.0f) < a;
+}
+
+/* returns an int in the range (0, n) (non-inclusive).
+ * Uses Lemire's multiply and shift, with rejection to avoid bias. */
+uint32_t random_uint32_t(Random *rng, uint32_t n) {
+	assert(n > 0);
+	uint64_t m = (uint64_t)random_next(rng) * n;
+	uint32_t low = (uint32_t)m;
+
+	if (low < n) {
+		uint32_t threshold = -n % n;
+		while (low < threshold) {
+			m = (uint64_t)random_next(rng) * n;
+			low = (uint32_t)m;
 		}
 	}
-	//NB since we check against i+1, i will always be < n
-	assert(i < n);
-
-	return i;
+	return m >> 32;
 }
 
 /* returns an angle in (0, 360.0) */
-float random_angle() {
-	return 360.0 * random_float(1.0);
+float random_angle(Random *rng) {
+	return 360.0 * random_float(rng, 1.0);
 }
 
+/* Seeds rng with seed. State is filled with splitmix64,
+ * so similar seeds still give unrelated sequences. */
+void random_seed(Random *rng, uint64_t seed) {
+	for (uint32_t i = 0; i < 4; i++) {
+		uint64_t z = (seed += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		rng->s[i] = (uint32_t)((z ^ (z >> 31)) >> 32);
+	}
+}
 
-/* Seeds random with time */
-void random_seed() {
-	srand(time(NULL));
+/* returns a seed based on time, for when none is given */
+uint64_t random_time_seed() {
+	return (uint64_t)time(NULL);
 }
 
 #endif /* RANDOM_C */
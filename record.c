@@ -0,0 +1,190 @@
+/*
+ * Records player input to a file, and reads it back for replays.
+ * Files start with a header holding the random seed, settings and
+ * limits, followed by events. Presses are only written when they change, so
+ * idle players cost nothing.
+ * All numbers are little endian, so files work across machines.
+ */
+#ifndef RECORD_C
+#define RECORD_C
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "types.h"
+#include "arena.c"
+
+/* writes n bytes of v to file, little endian */
+void record_put(FILE *file, uint64_t v, uint32_t n) {
+	for (uint32_t i = 0; i < n; i++) {
+		fputc((v >> (8 * i)) & 0xff, file);
+	}
+}
+
+/* reads n bytes from file, little endian.
+ * returns true on failure, false otherwise. */
+bool record_get(FILE *file, uint64_t *v, uint32_t n) {
+	*v = 0;
+	for (uint32_t i = 0; i < n; i++) {
+		int c = fgetc(file);
+		if (c == EOF) {
+			return true;
+		}
+		*v |= (uint64_t)c << (8 * i);
+	}
+	return false;
+}
+
+/* carves per player storage for limits->maxPlayers players from arena */
+void record_init(Recorder *rec, Arena *arena, Limits *limits) {
+	rec->lastPresses = arena_alloc(arena, limits->maxPlayers * sizeof(uint32_t));
+}
+
+/* Opens path for recording, and writes header.
+ * flags are RECORD_ flags for settings that change the game.
+ * returns true on failure, false otherwise. */
+bool record_open(Recorder *rec, const char *path, uint64_t seed, uint32_t flags, Limits *limits) {
+	rec->file = fopen(path, "wb");
+	if (rec->file == NULL) {
+		ILOG("couldn't open %s for recording", path);
+		return true;
+	}
+	rec->replaying = false;
+	fwrite(RECORD_MAGIC, 1, 4, rec->file);
+	record_put(rec->file, RECORD_VERSION, 4);
+	record_put(rec->file, seed, 8);
+	record_put(rec->file, flags, 4);
+	record_put(rec->file, limits->maxObjs, 4);
+	record_put(rec->file, limits->maxPlayers, 4);
+	record_put(rec->file, limits->maxAsteroids, 4);
+	record_put(rec->file, limits->worldW, 4);
+	record_put(rec->file, limits->worldH, 4);
+	return false;
+}
+
+/* true iff rec is writing input to a file */
+bool record_is_recording(Recorder *rec) {
+	return rec->file != NULL && !rec->replaying;
+}
+
+/* true iff rec is reading input from a file */
+bool record_is_replaying(Recorder *rec) {
+	return rec->file != NULL && rec->replaying;
+}
+
+/* writes an event, if recording. */
+void record_write(Recorder *rec, uint64_t tick, RecordEventType type, uint32_t slot, uint32_t value) {
+	if (!record_is_recording(rec)) {
+		return;
+	}
+	record_put(rec->file, tick, 4);
+	record_put(rec->file, type, 1);
+	record_put(rec->file, slot, 1);
+	record_put(rec->file, value, 4);
+}
+
+/* records player in slot joining, with parsec guest id (0 if local) */
+void record_join(Recorder *rec, uint64_t tick, uint32_t slot, uint32_t guestId) {
+	rec->lastPresses[slot] = 0;
+	record_write(rec, tick, RECORD_JOIN, slot, guestId);
+}
+
+/* records player in slot leaving */
+void record_leave(Recorder *rec, uint64_t tick, uint32_t slot) {
+	record_write(rec, tick, RECORD_LEAVE, slot, 0);
+}
+
+/* records presses for player in slot, if they changed */
+void record_presses(Recorder *rec, uint64_t tick, uint32_t slot, uint32_t presses) {
+	if (rec->lastPresses[slot] == presses) {
+		return;
+	}
+	rec->lastPresses[slot] = presses;
+	record_write(rec, tick, RECORD_PRESSES, slot, presses);
+}
+
+/* reads next event into rec->next. At end of file, makes an END event. */
+void record_read_next(Recorder *rec) {
+	uint64_t tick, type, slot, value;
+	RecordEvent *ev = &rec->next;
+
+	if (record_get(rec->file, &tick, 4) ||
+			record_get(rec->file, &type, 1) ||
+			record_get(rec->file, &slot, 1) ||
+			record_get(rec->file, &value, 4)) {
+		ILOG("replay ended without end event");
+		ev->type = RECORD_END;
+		return;
+	}
+	ev->tick = tick;
+	ev->type = type;
+	ev->slot = slot;
+	ev->value = value;
+}
+
+/* Opens path for replaying, reads header and first event.
+ * seed, flags and limits are set to those of the recorded game.
+ * returns true on failure, false otherwise. */
+bool record_open_replay(Recorder *rec, const char *path, uint64_t *seed, uint32_t *flags, Limits *limits) {
+	char magic[4];
+	uint64_t version, v, objs, players, asteroids, w, h;
+
+	rec->file = fopen(path, "rb");
+	if (rec->file == NULL) {
+		ILOG("couldn't open %s for replay", path);
+		return true;
+	}
+	rec->replaying = true;
+	if (fread(magic, 1, 4, rec->file) != 4 || memcmp(magic, RECORD_MAGIC, 4) != 0 ||
+			record_get(rec->file, &version, 4) || version != RECORD_VERSION ||
+			record_get(rec->file, seed, 8) ||
+			record_get(rec->file, &v, 4) ||
+			record_get(rec->file, &objs, 4) ||
+			record_get(rec->file, &players, 4) ||
+			record_get(rec->file, &asteroids, 4) ||
+			record_get(rec->file, &w, 4) ||
+			record_get(rec->file, &h, 4)) {
+		ILOG("%s is not a recording", path);
+		fclose(rec->file);
+		rec->file = NULL;
+		return true;
+	}
+	*flags = v;
+	limits->maxObjs = objs;
+	limits->maxPlayers = players;
+	limits->maxAsteroids = asteroids;
+	limits->worldW = w;
+	limits->worldH = h;
+	record_read_next(rec);
+	return false;
+}
+
+/* true iff the next replay event happens at tick */
+bool record_has_event(Recorder *rec, uint64_t tick) {
+	return record_is_replaying(rec) && rec->next.type != RECORD_END && rec->next.tick <= tick;
+}
+
+/* ends the replay at tick, skipping any events left */
+void record_end_replay(Recorder *rec, uint64_t tick) {
+	rec->next.type = RECORD_END;
+	rec->next.tick = tick;
+}
+
+/* true iff the replay has played out up to tick */
+bool record_is_done(Recorder *rec, uint64_t tick) {
+	return rec->next.type == RECORD_END && tick >= rec->next.tick;
+}
+
+/* Closes rec. If recording, writes end event at tick first. */
+void record_close(Recorder *rec, uint64_t tick) {
+	if (rec->file == NULL) {
+		return;
+	}
+	record_write(rec, tick, RECORD_END, 0, 0);
+	fclose(rec->file);
+	rec->file = NULL;
+}
+
+#endif /* RECORD_C */
@@ -0,0 +1,99 @@
+/*
+ * Batched drawing of objects.
+ * Instead of a raylib call per object, vertices for all visible
+ * objects are collected per type each frame, then submitted to
+ * rlgl a type at a time: outlines as lines, filled shapes as
+ * triangles. Missiles are filled squares, which look the same as
+ * DrawCircle at their size, without a fan of triangles each.
+ */
+#ifndef RENDER_C
+#define RENDER_C
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "types.h"
+#include "raylib.h"
+#include "rlgl.h"
+
+#include "arena.c"
+#include "object.c"
+
+/* carves a buffer per type, each fitting every object, from arena */
+void render_init(Renderer *r, Arena *arena, Limits *limits) {
+	size_t n = (size_t)limits->maxObjs * RENDER_MAX_VERTS;
+	for (uint32_t t = 1; t <= N_TYPES; t++) {
+		r->buffers[t].verts = arena_alloc(arena, n * sizeof(Vector2));
+		r->buffers[t].cols = arena_alloc(arena, n * sizeof(Color));
+	}
+}
+
+/* empties buffers, for a new frame */
+void render_begin(Renderer *r) {
+	for (uint32_t t = 0; t <= N_TYPES; t++) {
+		r->buffers[t].n = 0;
+	}
+	r->nCalls = 0;
+}
+
+/* appends vertex v with color col to buf */
+void render_vertex(RenderBuffer *buf, Vector2 v, Color col) {
+	buf->verts[buf->n] = v;
+	buf->cols[buf->n] = col;
+	buf->n++;
+}
+
+/* adds obj, alpha of the way between ticks, to the buffer for its type.
+ * Outlined types get a line per edge, filled ones a triangle fan. */
+void render_add(Renderer *r, Object *obj, float alpha) {
+	Vector2 corners[4];
+	uint32_t type = object_type(obj);
+	uint32_t n = object_draw_polygon(obj, alpha, corners);
+	Color col = object_draw_color(obj);
+
+	if (n == 0) {
+		ILOG("cannot draw unrecognized type %d", type);
+		return;
+	}
+	RenderBuffer *buf = &r->buffers[type];
+	if (RENDER_FILLED[type]) {
+		for (uint32_t i = 1; i + 1 < n; i++) {
+			render_vertex(buf, corners[0], col);
+			render_vertex(buf, corners[i], col);
+			render_vertex(buf, corners[i + 1], col);
+		}
+	} else {
+		for (uint32_t i = 0; i < n; i++) {
+			render_vertex(buf, corners[i], col);
+			render_vertex(buf, corners[(i + 1) % n], col);
+		}
+	}
+}
+
+/* submits buf to rlgl as mode primitives, in chunks that fit
+ * raylib's batch. returns number of chunks. */
+uint32_t render_submit(RenderBuffer *buf, int mode) {
+	uint32_t nChunks = 0;
+	for (uint32_t start = 0; start < buf->n; start += RENDER_CHUNK) {
+		uint32_t end = start + RENDER_CHUNK < buf->n ? start + RENDER_CHUNK : buf->n;
+		rlCheckRenderBatchLimit(end - start);
+		rlBegin(mode);
+		for (uint32_t i = start; i < end; i++) {
+			Color col = buf->cols[i];
+			rlColor4ub(col.r, col.g, col.b, col.a);
+			rlVertex2f(buf->verts[i].x, buf->verts[i].y);
+		}
+		rlEnd();
+		nChunks++;
+	}
+	return nChunks;
+}
+
+/* draws everything added since render_begin */
+void render_end(Renderer *r) {
+	for (uint32_t t = 1; t <= N_TYPES; t++) {
+		r->nCalls += render_submit(&r->buffers[t], RENDER_FILLED[t] ? RL_TRIANGLES : RL_LINES);
+	}
+}
+
+#endif /* RENDER_C */
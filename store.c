@@ -0,0 +1,170 @@
+/*
+ * Column storage for hot object data.
+ * Keeps the live list of active ids sorted, so loops
+ * over it run in the same order as over the object array.
+ * Also allocates free slots, from a bitmap of used ids.
+ */
+#ifndef STORE_C
+#define STORE_C
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "types.h"
+#include "arena.c"
+
+/* carves columns for limits->maxObjs objects from arena,
+ * and sets up reservations and world size from limits. */
+void store_init(ObjectStore *store, Arena *arena, Limits *limits) {
+	uint32_t n = limits->maxObjs;
+	store->capacity = n;
+	store->nWords = (n + 63) / 64;
+	store->x = arena_alloc(arena, n * sizeof(float));
+	store->y = arena_alloc(arena, n * sizeof(float));
+	store->vx = arena_alloc(arena, n * sizeof(float));
+	store->vy = arena_alloc(arena, n * sizeof(float));
+	store->px = arena_alloc(arena, n * sizeof(float));
+	store->py = arena_alloc(arena, n * sizeof(float));
+	store->type = arena_alloc(arena, n * sizeof(uint8_t));
+	store->flags = arena_alloc(arena, n * sizeof(uint8_t));
+	store->live = arena_alloc(arena, n * sizeof(uint16_t));
+	store->used = arena_alloc(arena, store->nWords * sizeof(uint64_t));
+	for (uint32_t t = 0; t <= N_TYPES; t++) {
+		store->reserved[t] = OBJECT_RESERVATIONS[t] * limits->maxPlayers;
+	}
+	store->worldW = limits->worldW;
+	store->worldH = limits->worldH;
+}
+
+/* returns position of first live id >= id. */
+uint32_t store_lower_bound(ObjectStore *store, uint32_t id) {
+	uint32_t lo = 0, hi = store->nLive;
+	while (lo < hi) {
+		uint32_t mid = (lo + hi) / 2;
+		if (store->live[mid] < id) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+/* adds id to live list, and marks it used. */
+void store_link(ObjectStore *store, uint32_t id) {
+	uint32_t k = store_lower_bound(store, id);
+	if (k < store->nLive && store->live[k] == id) {
+		return;
+	}
+	memmove(&store->live[k+1], &store->live[k], (store->nLive - k) * sizeof(store->live[0]));
+	store->live[k] = id;
+	store->nLive++;
+	store->used[id / 64] |= 1ull << (id % 64);
+	store->nType[store->type[id]]++;
+}
+
+/* removes id from live list, and frees it for allocation. */
+void store_unlink(ObjectStore *store, uint32_t id) {
+	uint32_t k = store_lower_bound(store, id);
+	if (k >= store->nLive || store->live[k] != id) {
+		return;
+	}
+	memmove(&store->live[k], &store->live[k+1], (store->nLive - k - 1) * sizeof(store->live[0]));
+	store->nLive--;
+	store->used[id / 64] &= ~(1ull << (id % 64));
+	store->nType[store->type[id]]--;
+	if (id / 64 < store->freeHint) {
+		store->freeHint = id / 64;
+	}
+}
+
+/* number of free slots that objects of type can't use,
+ * because they are reserved for other types. */
+uint32_t store_n_reserved(ObjectStore *store, uint32_t type) {
+	uint32_t reserved = 0;
+	for (uint32_t t = 1; t <= N_TYPES; t++) {
+		if (t != type && store->nType[t] < store->reserved[t]) {
+			reserved += store->reserved[t] - store->nType[t];
+		}
+	}
+	return reserved;
+}
+
+/* true iff there is a free slot for an object of type */
+bool store_can_alloc(ObjectStore *store, uint32_t type) {
+	return store->capacity - store->nLive > store_n_reserved(store, type);
+}
+
+/*
+ * Returns lowest free id for an object of type, or -1 if there
+ * is none. Counts failures in nExhausted.
+ * Slot isn't marked used until the object is activated.
+ */
+int32_t store_alloc(ObjectStore *store, uint32_t type) {
+	if (!store_can_alloc(store, type)) {
+		store->nExhausted[type]++;
+		return -1;
+	}
+	for (uint32_t w = store->freeHint; w < store->nWords; w++) {
+		uint64_t freeBits = ~store->used[w];
+		if (freeBits != 0) {
+			uint32_t id = w * 64 + __builtin_ctzll(freeBits);
+			store->freeHint = w;
+			if (id < store->capacity) {
+				return id;
+			}
+			break;
+		}
+	}
+	store->nExhausted[type]++;
+	return -1;
+}
+
+/* number of active objects */
+uint32_t store_n_live(ObjectStore *store) {
+	return store->nLive;
+}
+
+/* id of the k'th active object */
+uint32_t store_live(ObjectStore *store, uint32_t k) {
+	return store->live[k];
+}
+
+/* clears collision check counters, for the next tick */
+void store_reset_tests(ObjectStore *store) {
+	store->nPairTests = 0;
+	store->nNarrowTests = 0;
+}
+
+/* true iff object id has all of flags set */
+bool store_has_flags(ObjectStore *store, uint32_t id, uint8_t flags) {
+	return (store->flags[id] & flags) == flags;
+}
+
+/* sets or clears destroyed flag of id, and counts it by type.
+ * Type mustn't change while the flag is set. */
+void store_set_destroyed(ObjectStore *store, uint32_t id, bool destroyed) {
+	if (store_has_flags(store, id, OBJECT_DESTROYED) == destroyed) {
+		return;
+	}
+	if (destroyed) {
+		store->flags[id] |= OBJECT_DESTROYED;
+		store->nDestroyed[store->type[id]]++;
+	} else {
+		store->flags[id] &= ~OBJECT_DESTROYED;
+		store->nDestroyed[store->type[id]]--;
+	}
+}
+
+/* number of active objects of type */
+uint32_t store_n_type(ObjectStore *store, uint32_t type) {
+	return store->nType[type];
+}
+
+/* number of objects of type being destroyed */
+uint32_t store_n_destroyed(ObjectStore *store, uint32_t type) {
+	return store->nDestroyed[type];
+}
+
+#endif /* STORE_C */
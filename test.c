@@ -8,15 +8,16 @@
 #include "game.c"
 
 void test_run(GameState *state) {
-	Vector2 direction = vector_random_direction();
-	state->localPlayer->ship->direction = direction;
+	Vector2 direction = vector_random_direction(&state->rng);
+	object_set_direction(state->localPlayer->ship, direction);
 
-	game_draw(state);
+	game_draw(state, 1.0f);
 
 	game_handle_objects(state);
 
 	game_handle_frame_end(state);
 
+	game_snapshot_inputs(state);
 	game_handle_players(state);
 
 	game_handle_destructions(state);
@@ -26,21 +27,28 @@ void test_init(GameState *state) {
 
 	state->localPlayer = game_add_player(state, NULL);
 	assert(state->localPlayer);
-	state->localPlayer->p_space = true;
-	state->localPlayer->ship->x = 100;
-	state->localPlayer->ship->y = 100;
-	state->localPlayer->ship->destroyed = true;
+	player_set_press(state->localPlayer, PRESS_SPACE, true);
+	object_set_x(state->localPlayer->ship, 100);
+	object_set_y(state->localPlayer->ship, 100);
+	object_mark_respawn(state->localPlayer->ship);
 }
 
 int main(int argc, char *argv[])
 {
 	GameState state = { 0 };
 
-	game_init(&state);
+	if (!game_parse_options(&state, argc - 1, argv + 1)) {
+		printf("Usage: ./test [%s ticks]\n", HEADLESS_OPTION);
+		return 1;
+	}
+
+	if (game_init(&state)) {
+		return 1;
+	}
 
 	test_init(&state);
 
-	while (!WindowShouldClose())    // Detect window close button or ESC key
+	while (!game_should_close(&state))    // Detect window close button or ESC key
 	{
 		test_run(&state);
 	}
@@ -0,0 +1,67 @@
+/*
+ * Text cached in textures.
+ * Laying text out with raylib's font is a draw per glyph, so text
+ * that rarely changes, like scores, is drawn into a texture when it
+ * changes, and the texture is copied to the frame instead.
+ * Each text has a key standing for what it was made from, so
+ * callers only format text when the key changes, see text_is_stale.
+ * raylib can't draw into two textures at once, so texts are
+ * rendered before the frame is begun.
+ */
+#ifndef TEXT_C
+#define TEXT_C
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "types.h"
+#include "raylib.h"
+
+/* true iff text wasn't made from key in color */
+bool text_is_stale(CachedText *text, uint64_t key, Color color) {
+	return !text->loaded || text->key != key || !color_is_equal(text->color, color);
+}
+
+/* frees text's texture, if it has one */
+void text_unload(CachedText *text) {
+	if (text->loaded) {
+		UnloadRenderTexture(text->texture);
+		text->loaded = false;
+	}
+}
+
+/* draws str into text's texture, in color at fontSize, made from key.
+ * The texture is only reloaded if str's size changed. */
+void text_render(CachedText *text, const char *str, int fontSize, uint64_t key, Color color) {
+	int width = MeasureText(str, fontSize);
+	if (width < 1) {
+		width = 1;
+	}
+	if (text->loaded && (text->texture.texture.width != width || text->texture.texture.height != fontSize)) {
+		text_unload(text);
+	}
+	if (!text->loaded) {
+		text->texture = LoadRenderTexture(width, fontSize);
+		text->loaded = true;
+	}
+	BeginTextureMode(text->texture);
+	ClearBackground(BLANK);
+	DrawText(str, 0, 0, fontSize, color);
+	EndTextureMode();
+	text->key = key;
+	text->color = color;
+}
+
+/* draws text's texture with its top left at x, y. Nothing if not rendered. */
+void text_draw(CachedText *text, float x, float y) {
+	if (!text->loaded) {
+		return;
+	}
+	Texture2D texture = text->texture.texture;
+	//render textures are stored upside down, so flip with negative height.
+	Rectangle source = {0, 0, texture.width, -texture.height};
+	Vector2 position = {x, y};
+	DrawTextureRec(texture, source, position, WHITE);
+}
+
+#endif /* TEXT_C */
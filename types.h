@@ -1,7 +1,11 @@
 #ifndef TYPES_H
 #define TYPES_H
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "raylib.h"
 #include "parsec.h"
@@ -9,28 +13,45 @@
 #define DEBUG false
 #define INFO true
 
-#define DLOG(f_, ...) (DEBUG ? printf((f_), ##__VA_ARGS__), printf("\n") : 0)
-#define ILOG(f_, ...) (INFO ? printf((f_), ##__VA_ARGS__), printf("\n") : 0)
+#define DLOG(f_, ...) ((void)(DEBUG ? printf((f_), ##__VA_ARGS__), printf("\n") : 0))
+#define ILOG(f_, ...) ((void)(INFO ? printf((f_), ##__VA_ARGS__), printf("\n") : 0))
 
 /* Constants */
 //Constants are stored as const [type] as opposed to Enums. I anticipated making them settings,
 //so figured typing would be good here. I ended up not doing that, and not converting it because
 //it didn't seem like it would matter much either way.
+//The exception is constants that size arrays. Those are enums, since only clang accepts
+//const variables as array sizes, and other compilers make them variable length arrays.
 
 //Game Settings
-const uint32_t FPS = 60; //Can be set lower, useful for testing
-const uint32_t MAX_PLAYERS = 8; //this is quite arbitrary, just has implications on memory.
-const uint32_t SCREEN_W = 1600;
-const uint32_t SCREEN_H = (2 * SCREEN_W / 3); //arbitrary ratio
+const uint32_t FPS = 60; //Game ticks per second, all cooldowns are counted in these. Can be set lower, useful for testing
+const uint32_t RENDER_FPS = 120; //Frames drawn per second, independent of game ticks. Positions are interpolated between ticks.
+const uint32_t MAX_TICKS_PER_FRAME = 5; //if rendering falls further behind than this, we drop game time instead of catching up.
+enum { SCREEN_W = 1600 }; //window size, the world can be bigger, see Limits
+enum { SCREEN_H = (2 * SCREEN_W / 3) }; //arbitrary ratio
 const uint32_t SCOREBOARD_Y_OFFSET = 30; //how far down to render scores
 const uint32_t GAME_FONT_SIZE = 24;  //size of scoreboard is also font for
 const uint32_t RESET_COOLDOWN = FPS;
-const uint32_t MAX_OBJS = 200;
 const uint32_t WELCOME_TEXT_COOLDOWN = 5 * FPS;
 const char* GAME_NAME = "Asteroids BATTLE!";
 const char* WELCOME_TEXT = "Welcome to Asteroids Battle! Move: WASD/Arrows/Space | DPAD/A/B/X. Reset Game: Q | L+R Trigger. (Un)Spawn Local Player: O+U";
 const char* RESET_TEXT = "**wants[%d]reset**";
 const char* DISABLE_PARSEC = "noparsec";
+const char* HEADLESS_OPTION = "--headless"; //runs simulation only, no window. Takes a number of ticks, 0 to run forever.
+const char* PROFILE_OPTION = "--profile"; //takes a file to write frame profile to on exit.
+const char* SEED_OPTION = "--seed"; //takes a number to seed randomness with, so runs can be repeated.
+const char* RECORD_OPTION = "--record"; //takes a file to record input to, for replaying later.
+const char* REPLAY_OPTION = "--replay"; //takes a recorded file and replays it headless.
+const char* SWEPT_OPTION = "--swept"; //objects collide anywhere along their last move, so fast ones can't pass through each other.
+const char* OBJECTS_OPTION = "--objects"; //takes max number of objects.
+const char* PLAYERS_OPTION = "--players"; //takes max number of players.
+const char* ASTEROIDS_OPTION = "--asteroids"; //takes max number of asteroids.
+const char* WORLD_OPTION = "--world"; //takes world size as WxH, e.g. 4800x3200.
+
+//Profiler Settings
+enum { PROFILE_WINDOW = 512 }; //samples kept per stage for rolling stats
+const uint32_t PROFILE_REFRESH = 30; //frames between overlay updates
+const int PROFILE_OVERLAY_KEY = KEY_F3; //toggles profile overlay
 
 //Ship Settings
 const float SHIP_SPEED_ADJUSTMENT = 0.4; //chosen after playing around with options.
@@ -40,14 +61,46 @@ const uint32_t SHIP_MISSILE_COOLDOWN = 10; //NB: Measured in frames
 //ASTEROID Settings
 const uint32_t ASTEROID_MAX_SPEED = 8.0; //asteroid speed is uniformly distributed between 0 and this value.
 const uint32_t N_START_ASTEROIDS = 5; //spawns on reset
-const uint32_t MAX_ASTEROIDS = 30; //no more asteroids after this number.
-const float EXPECTED_ASTEROIDS_PER_SEC = 3; //used to calculate probability of asteroid spawning.
+const float EXPECTED_ASTEROIDS_PER_SEC = 3; //used to calculate probability of asteroid spawning, scales with max asteroids.
 const float ASTEROID_SPAWN_DRIVER = 0.05; //percentage increase/decrease in asteroid prob as n asteroids deviate from midpoint.
 
 //MISSILE Settings
 const int MISSILE_SPEED = 20.0;  //chosen after some testing.
 const float MISSILE_RADIUS = 1.0; //want them small
 
+//Broad Phase Settings
+//The world is split into a uniform grid, and collision checks only run
+//between objects that share a cell. Cells are ~2x the biggest object.
+enum { GRID_CELL_SIZE = 64 };
+enum { GRID_CELL_CAPACITY = 32 }; //objects per cell before spilling to the oversize list.
+const uint32_t GRID_MAX_SPAN = 16; //objects covering more cells than this (fast missiles) go in the oversize list.
+
+//View Settings
+const float CULL_MARGIN = GRID_CELL_SIZE; //objects are drawn partway along their last move, so look this far past the view for them.
+const Color WORLD_EDGE_COLOR = DARKGRAY; //outline of worlds bigger than the window
+const int RENDER_BATCH_KEY = KEY_F4; //toggles batched drawing, to compare frame times with drawing objects one by one
+enum { RENDER_MAX_VERTS = 8 }; //vertices per object in a render buffer, a 4 sided outline
+const uint32_t RENDER_CHUNK = 6 * 1024; //vertices submitted at once, fits raylib's batch. Multiple of 2 and 3 so lines and triangles aren't split.
+
+//Arena Settings
+//Defaults for Limits, which options can change at startup.
+//Everything they size is allocated once, from the arena. See arena.c.
+const uint32_t DEFAULT_MAX_OBJS = 200;
+const uint32_t DEFAULT_MAX_PLAYERS = 8; //this is quite arbitrary, just has implications on memory.
+const uint32_t DEFAULT_MAX_ASTEROIDS = 30; //no more asteroids after this number.
+const uint32_t DEFAULT_WORLD_W = SCREEN_W;
+const uint32_t DEFAULT_WORLD_H = SCREEN_H;
+const uint32_t OBJS_LIMIT = UINT16_MAX; //object ids are stored as uint16_t
+const uint32_t PLAYERS_LIMIT = 256; //player slots are recorded as one byte
+const uint32_t WORLD_MIN = 4 * GRID_CELL_SIZE;
+const uint32_t WORLD_LIMIT = 32768; //grid of 512x512 cells at most, about 17MB
+const size_t ARENA_ALIGN = 64; //cache line, also fits any SIMD loads
+
+//Input thread settings
+enum { INPUT_QUEUE_SIZE = 256 }; //events in flight from input thread to tick, must be a power of 2
+enum { CACHE_LINE = 64 }; //keeps queue ends written by different threads apart
+const uint32_t INPUT_POLL_TIMEOUT_MS = 1; //how long input thread waits for input before checking events
+
 //Types & Sizes
 //These are really enums, but I got a bit lazy so they are just stored ints
 typedef enum ObjectType {
@@ -56,7 +109,7 @@ typedef enum ObjectType {
   SHIP = 2,
   MISSILE = 3,
 } ObjectType;
-const uint32_t N_TYPES = 3; //used for destruction threshold.
+enum { N_TYPES = 3 }; //used for destruction threshold.
 
 const Vector2 ASTEROID_SIZE = {35.0, 35.0};
 const Vector2 SHIP_SIZE = {20.0, 20.0};  //ship dimensions are a triangle fit inside this box, with midpoint in one corner and two sides.
@@ -70,8 +123,29 @@ int DESTRUCTION_THRESHOLDS[N_TYPES+1] = {
 	0, //MISSILE
 };
 
+//Object slots held back for each type, per player, so other types can't use them up.
+//Ships get one per player so missiles can never starve a player joining.
+const uint32_t OBJECT_RESERVATIONS[N_TYPES+1] = {
+	0, //ignored
+	0, //ASTEROID
+	1, //SHIP
+	0, //MISSILE
+};
+
+//Which types are drawn filled, rather than outlined. See render.c.
+const bool RENDER_FILLED[N_TYPES+1] = {
+	false, //ignored
+	false, //ASTEROID
+	false, //SHIP
+	true, //MISSILE
+};
+
+//Trig lookup, see vector_rotate. Covers whole degrees in [-360, 360],
+//which is the range object angles and adjustments stay in.
+enum { TRIG_TABLE_SIZE = 2 * 360 + 1 };
+
 //Colors for Players
-const int N_COLORS = 8; //NB: used for indexing into below array, so must match.
+enum { N_COLORS = 8 }; //NB: used for indexing into below array, so must match.
 const Color COLORS[N_COLORS] = {
 	GOLD,
 	ORANGE,
@@ -83,27 +157,105 @@ const Color COLORS[N_COLORS] = {
 	BEIGE,
 };
 
+//owner of objects that belong to no player. Player handles are never 0.
+const uint32_t OBJECT_NO_OWNER = 0;
+
+//Object flags, stored per object in ObjectStore
+const uint8_t OBJECT_ACTIVE = 1 << 0;
+const uint8_t OBJECT_DESTROYED = 1 << 1;
+
+/*
+ * Hot object data that loops over all objects read,
+ * stored as columns so they only touch what they need.
+ * Columns are indexed by object id, same as GameState.objs.
+ * live is a compacted list of active object ids, kept in
+ * ascending order so it iterates in the same order as the array.
+ */
+typedef struct ObjectStore {
+	float *x, *y; //position in space
+	float *vx, *vy; //movement per frame, direction scaled by speed
+	float *px, *py; //position before last move, drawing interpolates from here
+	uint8_t *type; //what kind of object it is
+	uint8_t *flags; //OBJECT_ACTIVE etc.
+	uint16_t *live; //ids of active objects
+	uint32_t nLive;
+	uint32_t capacity; //object slots, the length of each column
+	uint64_t *used; //bitmap of active ids, used to find free slots
+	uint32_t nWords; //words in used
+	uint32_t freeHint; //no free slots in used words before this one
+	uint32_t nType[N_TYPES+1]; //active objects per type
+	uint32_t nDestroyed[N_TYPES+1]; //objects per type being destroyed, see OBJECT_DESTROYED
+	uint32_t reserved[N_TYPES+1]; //slots held back per type, see OBJECT_RESERVATIONS
+	float worldW, worldH; //size of the world objects move in, they wrap at the edges
+	uint32_t nExhausted[N_TYPES+1]; //failed allocations per type
+	uint32_t nPairTests; //collision checks between active objects, this tick
+	uint32_t nNarrowTests; //collision checks whose bounds overlapped, so points were tested
+	bool swept; //objects also collide along their last move, see object_is_sweep_colliding
+} ObjectStore;
+
 /* All Objects share the same struct, and store
  * all relevant game state information about themselves.
- * They have shared functions in object.c.
+ * They have shared functions in object.c, which are the only
+ * ones that should read the fields, since the hot fields are
+ * kept in an ObjectStore.
  * They are distinguished by their type field.
  */
 typedef struct Object {
-	float x, y, //position in space
-        w, h, //size
+	ObjectStore *store; //where position, velocity, type and flags are kept
+	uint32_t id; //index into store
+	float w, h, //size
         speed, //speed
         angle; //obj rotation
 	Vector2 direction; //direction object is moving.
 	int destroyed; //destruction is counter to animate destroyed.
-	int type;  //what kind of object it is
-	bool active;  //objects are on stack, so need active counter for simple gc.
 	uint64_t framecounter;  //an overloaded field. Stores frame when relevant events happened.
   //for ships, when last shot was made (for throttling)
   //for missiles, when it was launched (to account for not hitting source).
   //NB: this should be replaced with a better created_at + age system, but I haven't bothered.
 	Color col; //objects color
+	uint32_t owner; //handle of player owning ship or missile, see game_player_handle
+	Vector2 verts[4]; //world space points, cached. See object_verts.
+	uint32_t nVerts; //number of cached points
+	Vector2 lo, hi; //corners of box around points, cached. See object_bounds.
+	bool cached; //false when position, velocity or angle changed since cache was built.
 } Object;
 
+/*
+ * A cell of the broad phase grid. Stores indices
+ * into the object array.
+ */
+typedef struct GridCell {
+	uint16_t n; //number of objects in cell
+	uint16_t objs[GRID_CELL_CAPACITY];
+} GridCell;
+
+/*
+ * Which cells an object was inserted into, so
+ * it can be removed again when it moves.
+ */
+typedef struct GridSpan {
+	uint16_t x0, y0, x1, y1; //inclusive cell range
+	bool inserted; //false if object isn't in the grid
+	bool oversize; //true if object is in the oversize list instead of cells
+} GridSpan;
+
+/*
+ * Uniform grid broad phase over the arena.
+ * Objects are inserted into every cell their bounds touch.
+ * Only valid while objects are being handled, outside of that
+ * collision checks fall back to scanning all objects.
+ */
+typedef struct Grid {
+	GridCell *cells; //rows * cols, row by row
+	uint32_t cols, rows; //enough cells to cover the world
+	uint32_t capacity; //object slots, the length of spans, oversize and stamps
+	GridSpan *spans; //indexed same as objects
+	uint16_t *oversize; //objects too big or crowded for cells, always checked
+	uint32_t nOversize;
+	uint32_t *stamps; //used to dedupe objects found in several cells
+	uint32_t stamp;
+	bool valid;
+} Grid;
 
 /*
  * Game state for a player. Can be connected via Parsec
@@ -116,60 +268,311 @@ typedef struct Object {
 typedef struct Player {
 	ParsecGuest guest; //parsec guest data. Stored on object b/c received data goes away.
 	Object *ship;  //pointer to ship object in object array
+	Camera2D camera; //view that follows ship, see camera.c
 	Color col;  //color
 	int score;  //for scoreboard
 	bool active; //active for garbage collection on stack.
-	bool p_w;  //keyboard presses
-	bool p_up;
-	bool p_s;
-	bool p_down;
-	bool p_a;
-	bool p_left;
-	bool p_d;
-	bool p_right;
-	bool p_space;
-	bool p_q;
-	bool p_g_up; //gamepad presses
-	bool p_g_down;
-	bool p_g_left;
-	bool p_g_right;
-	bool p_g_a;
-	bool p_g_b;
-	bool p_g_x;
-	bool p_g_lt;
-	bool p_g_rt;
+	uint16_t generation; //bumped every time slot is taken, so handles to earlier players don't match
+	uint32_t presses; //keys and buttons held, as PRESS_ bits below
 } Player;
 
+//Player presses, one bit per key or button.
+//Kept packed everywhere: input, the per tick snapshot and recordings.
+const uint32_t PRESS_W = 1 << 0;
+const uint32_t PRESS_UP = 1 << 1;
+const uint32_t PRESS_S = 1 << 2;
+const uint32_t PRESS_DOWN = 1 << 3;
+const uint32_t PRESS_A = 1 << 4;
+const uint32_t PRESS_LEFT = 1 << 5;
+const uint32_t PRESS_D = 1 << 6;
+const uint32_t PRESS_RIGHT = 1 << 7;
+const uint32_t PRESS_SPACE = 1 << 8;
+const uint32_t PRESS_Q = 1 << 9;
+const uint32_t PRESS_G_UP = 1 << 10;
+const uint32_t PRESS_G_DOWN = 1 << 11;
+const uint32_t PRESS_G_LEFT = 1 << 12;
+const uint32_t PRESS_G_RIGHT = 1 << 13;
+const uint32_t PRESS_G_A = 1 << 14;
+const uint32_t PRESS_G_B = 1 << 15;
+const uint32_t PRESS_G_X = 1 << 16;
+const uint32_t PRESS_G_LT = 1 << 17;
+const uint32_t PRESS_G_RT = 1 << 18;
+
+//Recording file format, see record.c
+const char* RECORD_MAGIC = "ASTR"; //first 4 bytes of every recording
+const uint32_t RECORD_VERSION = 3; //bump when format changes
+const uint32_t RECORD_SWEPT = 1 << 0; //header flag, game used swept collisions
+
+typedef enum RecordEventType {
+	RECORD_PRESSES = 0, //value is player's presses
+	RECORD_JOIN = 1, //value is parsec guest id, 0 for local player
+	RECORD_LEAVE = 2,
+	RECORD_END = 3, //last event, tick is when recording stopped
+} RecordEventType;
+
+/* An input event, at the tick it happened */
+typedef struct RecordEvent {
+	uint64_t tick;
+	RecordEventType type;
+	uint32_t slot; //index of player in players array
+	uint32_t value;
+} RecordEvent;
+
+/*
+ * Records input to, or replays it from, a file.
+ * Inactive if file is NULL.
+ */
+typedef struct Recorder {
+	FILE *file;
+	bool replaying; //reading from file, otherwise writing
+	uint32_t *lastPresses; //last written presses per player, to only write changes
+	RecordEvent next; //next event to replay
+} Recorder;
+
+/*
+ * State of the random number generator, see random.c
+ */
+typedef struct Random {
+	uint32_t s[4];
+} Random;
+
+/*
+ * Stages of the game loop that are profiled.
+ * FRAME is a whole pass of the loop, TICK a whole game tick.
+ */
+typedef enum ProfileStage {
+	PROFILE_FRAME = 0,
+	PROFILE_TICK,
+	PROFILE_RESET,
+	PROFILE_DRAW,
+	PROFILE_SUBMIT_FRAME,
+	PROFILE_OBJECTS,
+	PROFILE_DESTRUCTIONS,
+	PROFILE_SPAWN,
+	PROFILE_INPUT_LATENCY,
+	PROFILE_PARSEC_INPUT,
+	PROFILE_LOCAL_INPUT,
+	PROFILE_PLAYERS,
+	PROFILE_FRAME_END,
+	PROFILE_RECORD,
+	N_PROFILE_STAGES,
+} ProfileStage;
+
+//NB: used for indexing by stage, so must match above.
+const char* PROFILE_STAGE_NAMES[N_PROFILE_STAGES] = {
+	"frame",
+	"tick",
+	"reset",
+	"draw",
+	"submit_frame",
+	"objects",
+	"destructions",
+	"spawn",
+	"input_latency",
+	"parsec_input",
+	"local_input",
+	"players",
+	"frame_end",
+	"record",
+};
+
+/* Rolling stats for a stage, in microseconds */
+typedef struct ProfileStats {
+	double min, avg, p99;
+	uint32_t n; //samples stats are based on
+} ProfileStats;
+
+/*
+ * How many players and objects there are, by type and state.
+ * Kept as counters while the game runs, see game_get_stats.
+ */
+typedef struct GameStats {
+	uint32_t nPlayers; //active players
+	uint32_t nLive; //active objects
+	uint32_t capacity; //object slots
+	uint32_t nType[N_TYPES+1]; //active objects per type
+	uint32_t nDestroyed[N_TYPES+1]; //active objects per type being destroyed
+} GameStats;
+
+/*
+ * Timings for each stage of the game loop.
+ * Keeps a window of recent samples per stage, plus totals
+ * over the whole run. All times in nanoseconds.
+ */
+typedef struct Profiler {
+	uint64_t samples[N_PROFILE_STAGES][PROFILE_WINDOW]; //ring buffer per stage
+	uint32_t next[N_PROFILE_STAGES]; //where next sample goes
+	uint32_t n[N_PROFILE_STAGES]; //samples in window
+	uint64_t started[N_PROFILE_STAGES]; //when stage was begun
+	uint64_t total[N_PROFILE_STAGES]; //sum of all samples
+	uint64_t count[N_PROFILE_STAGES]; //number of all samples
+	uint64_t worst[N_PROFILE_STAGES]; //biggest sample
+	ProfileStats shown[N_PROFILE_STAGES]; //stats on overlay
+	uint32_t sinceRefresh; //overlay draws since stats were updated
+	bool overlay; //draw stats on screen
+	uint32_t tickPairTests, tickNarrowTests; //collision checks in last tick, see ObjectStore
+	uint32_t frameDrawn, frameLive; //objects drawn in last frame after culling, and active objects
+	uint32_t frameDrawCalls; //draws submitted for objects in last frame, batches or single objects
+	bool frameBatched; //last frame's objects were drawn batched
+	GameStats tickStats; //population after last tick
+	uint32_t peakLive, peakPlayers; //most objects and players after any tick
+	uint64_t pairTests, narrowTests; //collision checks over all ticks
+} Profiler;
+
+/*
+ * Missiles and asteroids laid out for batch collision
+ * tests, see collide.c. Index i in the missile columns
+ * and j in the asteroid columns, ids map back to objects.
+ */
+typedef struct CollideBatch {
+	float *mx, *my; //missile position
+	float *mpx, *mpy; //missile position before last move
+	uint16_t *missiles; //object ids
+	uint32_t nMissiles;
+	float *ax0, *ay0; //asteroid top left corner
+	float *ax1, *ay1; //asteroid bottom right corner
+	uint16_t *asteroids; //object ids
+	uint32_t nAsteroids;
+	uint32_t capacity; //length of each column
+} CollideBatch;
+
+/*
+ * Vertices for all objects of one type, built each frame
+ * and submitted in one go, see render.c.
+ */
+typedef struct RenderBuffer {
+	Vector2 *verts;
+	Color *cols; //per vertex
+	uint32_t n; //vertices added this frame
+} RenderBuffer;
+
+/*
+ * Draws objects in batches, one buffer per type.
+ * Indexed by type, like DESTRUCTION_THRESHOLDS.
+ */
+typedef struct Renderer {
+	RenderBuffer buffers[N_TYPES+1];
+	uint32_t nCalls; //batches submitted this frame
+	bool batched; //draw through buffers, otherwise object by object with object_draw
+} Renderer;
+
+//What an InputEvent holds
+typedef enum InputEventType {
+	INPUT_GUEST_STATE = 1, //guest connected or disconnected
+	INPUT_MESSAGE = 2, //key or button from guest
+} InputEventType;
+
+/* parsec event or input, as polled by the input thread */
+typedef struct InputEvent {
+	InputEventType type;
+	ParsecGuest guest;
+	ParsecMessage msg; //if INPUT_MESSAGE
+	uint64_t received; //profile_now when polled, for measuring latency
+} InputEvent;
+
+/*
+ * Single producer, single consumer ring of input events,
+ * see inputqueue.c. head and tail count up forever, and are
+ * only written by one side each, so no locks are needed.
+ */
+typedef struct InputQueue {
+	InputEvent events[INPUT_QUEUE_SIZE];
+	_Alignas(CACHE_LINE) _Atomic uint32_t head; //next event to pop, written by consumer
+	_Alignas(CACHE_LINE) _Atomic uint32_t tail; //next event to push, written by producer
+	_Atomic uint32_t nStalls; //pushes that had to wait for room
+} InputQueue;
+
+/* thread that polls parsec into a queue, see parsecify.c */
+typedef struct InputThread {
+	pthread_t thread;
+	_Atomic bool running;
+	Parsec *parsec;
+	InputQueue queue;
+} InputThread;
+
+/*
+ * Hash map from parsec guest id to player slot, see guestmap.c.
+ * Buckets are a power of 2.
+ */
+typedef struct GuestMap {
+	uint32_t *ids; //guest id per bucket
+	uint16_t *slots; //player slot + 1 per bucket, 0 if empty
+	uint32_t mask; //buckets - 1
+} GuestMap;
+
+/*
+ * Text drawn once into a texture, then copied each frame,
+ * until what it shows changes. See text.c.
+ */
+typedef struct CachedText {
+	RenderTexture2D texture; //holds text, if loaded
+	uint64_t key; //what the text was made from, if the same the text is too
+	Color color;
+	bool loaded;
+} CachedText;
+
+/*
+ * Block of memory that storage sized at startup is carved
+ * from, see arena.c. base is NULL while only counting bytes.
+ */
+typedef struct Arena {
+	uint8_t *base;
+	size_t size, used;
+} Arena;
+
+/*
+ * How big the game is, set at startup. Storage is sized
+ * by these, so they can't change once the game is running.
+ * Zero fields are filled in with defaults.
+ */
+typedef struct Limits {
+	uint32_t maxObjs; //object slots, shared by all types
+	uint32_t maxPlayers;
+	uint32_t maxAsteroids; //no more asteroids spawn after this many
+	uint32_t worldW, worldH; //world size, may be bigger than the window
+} Limits;
+
 /*
  * Stores state of the game.
- * We don't allocate anything dynamically, so all objects'
- * are stored in this state on the stack, then passed by
- * reference.  As such, all objects have an active/inactive
- * bool bit set.
+ * Players and objects are allocated once at startup, from
+ * the arena, sized by limits. After that nothing is allocated,
+ * so all players and objects have an active/inactive bit set.
  */
 typedef struct GameState {
-	Player players[MAX_PLAYERS]; //All players, active and inactive
-	Object objs[MAX_OBJS]; //All objects, active and inactive
+	Limits limits; //how many players and objects, and how big the world is
+	Arena arena; //holds everything sized by limits
+	Player *players; //All players, active and inactive
+	uint32_t nPlayers; //active players, counted by game_add_player and game_remove_player
+	uint32_t *inputs; //presses per player slot for this tick, see game_snapshot_inputs
+	GuestMap guests; //player slots of parsec guests, kept by game_add_player and game_remove_player
+	Object *objs; //All objects, active and inactive
+	ObjectStore store; //hot columns for objs
+	uint16_t *candidates; //scratch for collision and culling candidates, fits limits.maxObjs
+	bool cullStale; //objects changed since the grid was last built for culling
+	Renderer renderer; //batches object drawing
+	CachedText welcomeText; //WELCOME_TEXT, drawn once
+	CachedText *scoreTexts; //each player's score, by player slot
 	uint64_t framecounter; //which frame we are on, used for timing instead of time.h
+	uint64_t ticks; //total frames simulated, not reset with game.
 	uint32_t welcomeTextCooldown; //used to track how long to show welcome text
   Parsec *parsec; //active parsec instance
+	InputThread parsecInput; //polls parsec, drained at the start of each tick
   Player *localPlayer; //pointer to local player in player array, if spawned.
+	Grid grid; //broad phase for collisions
+	Random rng; //all randomness in the game comes from here
+	uint64_t seed; //what rng was seeded with
+	bool seeded; //true if seed was given, otherwise it's based on time
+	bool headless; //no window, drawing or local input. Just simulates.
+	uint64_t tickLimit; //stop after this many ticks when headless, 0 for never.
+	RenderTexture2D frame; //game is drawn here, then copied to screen and sent to parsec
+	Profiler profiler; //timings for game loop stages
+	char *profilePath; //where to write profile on exit, if set
+	double lastFrameTime; //when last frame was drawn, in seconds
+	double tickAccumulator; //time passed that hasn't been simulated yet, in seconds
+	Recorder recorder; //input recording or replay, if either is on
+	char *recordPath; //where to record input to, if set
 } GameState;
 
-/*
- * Enumeration for which action to take on
- * the ship, if any. Triggered by input checking
- * against player state.
- */
-typedef enum ShipAction {
-	NO_ACTION = 0,
-	TURN_LEFT = 1,
-	TURN_RIGHT = 2,
-	SPEED_UP = 3,
-	SPEED_DOWN = 4,
-	SHOOT = 5,
-} ShipAction;
-
 /* utility functions that don't really belong in a .c file. */
 bool color_is_equal(Color c1, Color c2) {
 	return c1.r == c2.r &&
@@ -181,5 +584,6 @@ bool color_is_equal(Color c1, Color c2) {
 Player* game_get_player_from_guest(GameState *state, ParsecGuest *guest);
 Player* game_add_player(GameState *state, ParsecGuest *guest);
 bool game_remove_player(GameState *state, Player *p);
+void player_set_press(Player *p, uint32_t bits, bool pressed);
 
 #endif /* TYPES_H */
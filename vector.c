@@ -54,11 +54,37 @@ bool vector_is_equal(Vector2 v1, Vector2 v2) {
 /** VECTOR OPS **/
 //All return new vector
 
+//sin and cos of whole degrees, offset by 360 so negative angles index too.
+//Kept in double so rotations match calling sin/cos directly.
+double vectorSin[TRIG_TABLE_SIZE];
+double vectorCos[TRIG_TABLE_SIZE];
+bool vectorTrigBuilt = false;
+
+/* fills trig tables. Runs once, on first rotation. */
+void vector_init_trig() {
+	for (uint32_t i = 0; i < TRIG_TABLE_SIZE; i++) {
+		int angle = (int)i - 360;
+		vectorSin[i] = sin(angle*DEG2RAD);
+		vectorCos[i] = cos(angle*DEG2RAD);
+	}
+	vectorTrigBuilt = true;
+}
+
 /* rotates a vector angle degrees, returns new vector.
- * NB: does radian conversion */
+ * Looks up sin/cos in a table, angles outside [-360, 360]
+ * are wrapped into it first. */
 Vector2 vector_rotate(Vector2 v, int angle) {
-	float newX = (v.x * cos(angle*DEG2RAD)) - (v.y * sin(angle*DEG2RAD));
-	float newY = (v.x * sin(angle*DEG2RAD)) + (v.y * cos(angle*DEG2RAD));
+	if (!vectorTrigBuilt) {
+		vector_init_trig();
+	}
+	if (angle < -360 || angle > 360) {
+		angle %= 360;
+	}
+	double c = vectorCos[angle + 360];
+	double s = vectorSin[angle + 360];
+
+	float newX = (v.x * c) - (v.y * s);
+	float newY = (v.x * s) + (v.y * c);
 
 	Vector2 res = {newX, newY};
 	return res;
@@ -99,16 +125,16 @@ Vector2 vector_fixed_direction() {
 }
 
 /* returns a random direction */
-Vector2 vector_random_direction() {
-	float angle = random_angle();
+Vector2 vector_random_direction(Random *rng) {
+	float angle = random_angle(rng);
 	Vector2 v = {1.0, 0.0};
 
 	return vector_rotate(v, angle);
 }
 
-/* returns a random position */
-Vector2 vector_random_position() {
-	Vector2 v = {SCREEN_W * random_float(1.0), SCREEN_H * random_float(1.0)};
+/* returns a random position in a w by h world */
+Vector2 vector_random_position(Random *rng, float w, float h) {
+	Vector2 v = {w * random_float(rng, 1.0), h * random_float(rng, 1.0)};
 	return v;
 }
 